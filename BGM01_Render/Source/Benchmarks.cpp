@@ -0,0 +1,774 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Created: 16 Nov 2024 10:41:05am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include <iostream>
+#include <thread>
+#include "../../BGM01_Synthesizer/Source/Synthesizer.h"
+#include "../../BGM01_Synthesizer/Source/NoiseGenerator.h"
+#include "../../BGM01_Synthesizer/Source/StateVariableFilter.h"
+#include "../../BGM01_Synthesizer/Source/Envelope.h"
+#include "../../BGM01_Synthesizer/Source/UnisonOscillator.h"
+#include "../../BGM01_Synthesizer/Source/OscillatorBank.h"
+#include "../../BGM01_Synthesizer/Source/SynthEngine.h"
+#include "../../BGM01_Synthesizer/Source/FastMath.h"
+#include "../../BGM01_Synthesizer/Source/AudioAnalyser.h"
+#include "../../BGM01_Synthesizer/Source/AllocationGuard.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Results are written here so the compiler can't throw the work away
+    static volatile float benchmarkSink = 0.0f;
+
+    static constexpr int    blockSizes[]    = { 32, 64, 128, 256, 512, 1024, 2048 };
+    static constexpr int    voiceCounts[]   = { 1, 8, 16, 32, 64 };
+    static constexpr double sampleRates[]   = { 44100.0, 48000.0, 96000.0 };
+
+    // Oscillators are created through the base class so the per sample calls go
+    // through the virtual function, like they do in a generic voice
+    enum class OscillatorType
+    {
+        saw,
+        square,
+        noise,
+        wavetable
+    };
+
+    // @brief       Function to get the bank the wavetable cases read, built the first time
+    // @param       None
+    static const WavetableBank& getBenchmarkBank()
+    {
+        static WavetableBank bank;
+        if (! bank.isLoaded())
+        {
+            bank.createBasic(WavetableBank::defaultTableSize);
+        }
+        return bank;
+    }
+
+    // @brief       Function to make an oscillator of the given type
+    // @param       type = Which oscillator
+    //              bandLimited = True for PolyBLEP oscillators
+    static std::unique_ptr<SynthesizerBase> makeOscillator(OscillatorType type, bool bandLimited)
+    {
+        std::unique_ptr<SynthesizerBase> oscillator;
+
+        switch (type)
+        {
+            case OscillatorType::saw:       oscillator = std::make_unique<SawtoothSynth>(0.1f, 220.0f);    break;
+            case OscillatorType::square:    oscillator = std::make_unique<SquareSynth>(0.1f, 220.0f);      break;
+            case OscillatorType::noise:     oscillator = std::make_unique<NoiseSynth>(0.1f);               break;
+            case OscillatorType::wavetable: oscillator = std::make_unique<WavetableSynth>(0.1f, 220.0f, &getBenchmarkBank()); break;
+        }
+
+        oscillator->setSampleRate(48000.0);
+        oscillator->setBandLimited(bandLimited);
+        return oscillator;
+    }
+
+    // @brief       Constructor
+    // @param       minSeconds = Shortest time each repetition of a case runs for
+    //              repetitions = Number of times each case is timed, the fastest is kept
+    Benchmarks::Benchmarks(double minSeconds, int repetitions)
+    {
+        _minSeconds     = minSeconds;
+        _repetitions    = juce::jmax(1, repetitions);
+    }
+
+    // @brief       Function to run the benchmarks
+    // @param       filter = Only cases with this text in their name are run, empty for all
+    void Benchmarks::run(const juce::String& filter)
+    {
+        _filter = filter;
+        _results.clear();
+
+        std::cout << juce::String("case").paddedRight(' ', 40)
+                  << juce::String("ns/sample").paddedLeft(' ', 12)
+                  << juce::String("voices/core").paddedLeft(' ', 14) << std::endl;
+
+        runOscillators();
+        runNoise();
+        runFilters();
+        runEnvelope();
+        runUnison();
+        runOscillatorBank();
+        runEngine();
+        runMath();
+        runAnalyser();
+    }
+
+    // @brief       Function to get the results as CSV, for comparing runs
+    // @param       None
+    juce::String Benchmarks::toCsv() const
+    {
+        juce::String csv = "case,ns_per_sample,voices_per_core\n";
+
+        for (auto& result : _results)
+        {
+            csv += result.name + "," + juce::String(result.nsPerSample, 3) + "," + juce::String(result.voicesPerCore, 1) + "\n";
+        }
+
+        return csv;
+    }
+
+    // @brief       Function to time the oscillators, per sample and per block
+    // @param       None
+    void Benchmarks::runOscillators()
+    {
+        struct OscillatorCase
+        {
+            const char*     name;
+            OscillatorType  type;
+            bool            bandLimited;
+        };
+
+        const OscillatorCase cases[] = { { "saw/naive",     OscillatorType::saw,    false },
+                                         { "saw/polyblep",  OscillatorType::saw,    true  },
+                                         { "square/naive",  OscillatorType::square, false },
+                                         { "square/polyblep", OscillatorType::square, true },
+                                         { "noise",         OscillatorType::noise,  false },
+                                         { "wavetable/level0", OscillatorType::wavetable, false },
+                                         { "wavetable/mip", OscillatorType::wavetable, true } };
+
+        std::vector<float> buffer(static_cast<size_t>(2048));
+
+        for (auto& oscCase : cases)
+        {
+            auto oscillator = makeOscillator(oscCase.type, oscCase.bandLimited);
+
+            const juce::String sampleName = juce::String("osc/") + oscCase.name + "/sample";
+            if (isEnabled(sampleName))
+            {
+                constexpr int numSamples = 256;
+                const double ns = measure([&]
+                {
+                    float sum = 0.0f;
+                    for (int sample = 0; sample < numSamples; sample++)
+                    {
+                        sum += oscillator->sample();
+                    }
+                    benchmarkSink = sum;
+                }, numSamples);
+
+                addResult(sampleName, ns, 0.0);
+            }
+
+            for (int blockSize : { 32, 256, 2048 })
+            {
+                const juce::String blockName = juce::String("osc/") + oscCase.name + "/block" + juce::String(blockSize);
+                if (isEnabled(blockName))
+                {
+                    const double ns = measure([&]
+                    {
+                        juce::FloatVectorOperations::clear(buffer.data(), blockSize);
+                        oscillator->renderBlock(buffer.data(), blockSize);
+                        benchmarkSink = buffer[0];
+                    }, blockSize);
+
+                    addResult(blockName, ns, 0.0);
+                }
+            }
+        }
+    }
+
+    // @brief       Function to time the block noise generator in each colour
+    // @param       None
+    void Benchmarks::runNoise()
+    {
+        const std::pair<const char*, NoiseColour> colours[] = { { "white", NoiseColour::white },
+                                                                { "pink",  NoiseColour::pink  },
+                                                                { "brown", NoiseColour::brown } };
+
+        std::vector<float> buffer(static_cast<size_t>(2048));
+
+        for (auto& colour : colours)
+        {
+            NoiseGenerator noise;
+            noise.setColour(colour.second);
+            noise.setLevel(0.1f);
+
+            for (int blockSize : { 32, 256, 2048 })
+            {
+                const juce::String name = juce::String("noisegen/") + colour.first + "/block" + juce::String(blockSize);
+                if (isEnabled(name))
+                {
+                    const double ns = measure([&]
+                    {
+                        juce::FloatVectorOperations::clear(buffer.data(), blockSize);
+                        noise.renderBlock(buffer.data(), blockSize);
+                        benchmarkSink = buffer[0];
+                    }, blockSize);
+
+                    addResult(name, ns, 0.0);
+                }
+            }
+        }
+    }
+
+    // @brief       Function to time the voice filter, both the old biquad and the
+    //              state variable filter that replaced it
+    // @param       None
+    void Benchmarks::runFilters()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize     = 256;
+
+        juce::ScopedNoDenormals noDenormals;
+
+        std::vector<float> input(static_cast<size_t>(blockSize));
+        std::vector<float> buffer(static_cast<size_t>(blockSize));
+        juce::Random random(1);
+        for (auto& sample : input)
+        {
+            sample = (random.nextFloat() * 0.2f) - 0.1f;
+        }
+
+        if (isEnabled("filter/biquad/sample"))
+        {
+            juce::dsp::IIR::Filter<float> filter;
+            filter.coefficients = new juce::dsp::IIR::Coefficients<float>(juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, 1000.0f));
+            filter.reset();
+
+            const double ns = measure([&]
+            {
+                for (int sample = 0; sample < blockSize; sample++)
+                {
+                    buffer[static_cast<size_t>(sample)] = filter.processSample(input[static_cast<size_t>(sample)]);
+                }
+                filter.snapToZero();
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult("filter/biquad/sample", ns, 0.0);
+        }
+
+        if (isEnabled("filter/svf/block"))
+        {
+            StateVariableFilter filter;
+            filter.setSampleRate(sampleRate);
+            filter.setCutoff(1000.0f);
+            filter.reset();
+
+            const double ns = measure([&]
+            {
+                std::copy(input.begin(), input.end(), buffer.begin());
+                filter.process(buffer.data(), blockSize);
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult("filter/svf/block", ns, 0.0);
+        }
+
+        // Moving the cutoff every block, as an envelope or LFO would
+        if (isEnabled("filter/svf/sweep"))
+        {
+            StateVariableFilter filter;
+            filter.setSampleRate(sampleRate);
+            filter.reset();
+
+            float cutoff = 100.0f;
+            const double ns = measure([&]
+            {
+                cutoff = (10000.0f < cutoff) ? 100.0f : (cutoff * 1.05f);
+                filter.setCutoff(cutoff);
+
+                std::copy(input.begin(), input.end(), buffer.begin());
+                filter.process(buffer.data(), blockSize);
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult("filter/svf/sweep", ns, 0.0);
+        }
+    }
+
+    // @brief       Function to time the envelope, held in each stage and running
+    //              through whole notes
+    // @param       None
+    void Benchmarks::runEnvelope()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize     = 256;
+
+        std::vector<float> buffer(static_cast<size_t>(blockSize));
+
+        // Long times keep the envelope in the stage being timed
+        struct StageCase
+        {
+            const char*     name;
+            float           attack;
+            bool            released;
+        };
+
+        const StageCase cases[] = { { "envelope/attack",  1000.0f, false },
+                                    { "envelope/sustain", 0.0f,    false },
+                                    { "envelope/release", 0.0f,    true  } };
+
+        for (auto& stageCase : cases)
+        {
+            if (isEnabled(stageCase.name))
+            {
+                Envelope envelope;
+                envelope.setSampleRate(sampleRate);
+                envelope.setParameters(stageCase.attack, 0.0f, 0.5f, 1000.0f);
+                envelope.noteOn();
+
+                // Gets the zero length attack and decay out of the way
+                envelope.process(buffer.data(), blockSize);
+                if (stageCase.released)
+                {
+                    envelope.noteOff();
+                }
+
+                const double ns = measure([&]
+                {
+                    std::fill(buffer.begin(), buffer.end(), 0.5f);
+                    envelope.process(buffer.data(), blockSize);
+                    benchmarkSink = buffer[0];
+                }, blockSize);
+
+                addResult(stageCase.name, ns, 0.0);
+            }
+        }
+
+        // Short notes, so the block boundaries keep landing inside segments
+        if (isEnabled("envelope/notes"))
+        {
+            Envelope envelope;
+            envelope.setSampleRate(sampleRate);
+            envelope.setParameters(0.01f, 0.05f, 0.5f, 0.05f);
+
+            int block = 0;
+            const double ns = measure([&]
+            {
+                if (0 == (block % 40))
+                {
+                    envelope.noteOn();
+                }
+                else if (20 == (block % 40))
+                {
+                    envelope.noteOff();
+                }
+                block++;
+
+                std::fill(buffer.begin(), buffer.end(), 0.5f);
+                envelope.process(buffer.data(), blockSize);
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult("envelope/notes", ns, 0.0);
+        }
+    }
+
+    // @brief       Function to time one voice's unison stack for different sizes,
+    //              mono and with the stereo spread
+    // @param       None
+    void Benchmarks::runUnison()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize     = 256;
+
+        std::vector<float> left(static_cast<size_t>(blockSize));
+        std::vector<float> right(static_cast<size_t>(blockSize));
+
+        for (int numOscillators = 1; numOscillators <= UnisonOscillator::maxOscillators; numOscillators *= 2)
+        {
+            for (bool stereo : { false, true })
+            {
+                const juce::String name = "unison/saws" + juce::String(numOscillators) + (stereo ? "/stereo" : "/mono");
+                if (! isEnabled(name))
+                {
+                    continue;
+                }
+
+                auto unison = std::make_unique<UnisonOscillator>();
+                unison->setSampleRate(sampleRate);
+                unison->setFrequency(220.0f);
+                unison->setUnison(numOscillators, 20.0f, (stereo ? 0.5f : 0.0f));
+                unison->setLevel(0.5f);
+                unison->resetPhases(1);
+
+                const double ns = measure([&]
+                {
+                    std::fill(left.begin(), left.end(), 0.0f);
+                    std::fill(right.begin(), right.end(), 0.0f);
+                    unison->render(left.data(), (stereo ? right.data() : nullptr), blockSize);
+                    benchmarkSink = left[0];
+                }, blockSize);
+
+                addResult(name, ns, 1.0e9 / (ns * sampleRate));
+            }
+        }
+    }
+
+    // @brief       Function to time the oscillator bank for different voice counts
+    // @param       None
+    void Benchmarks::runOscillatorBank()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize     = SynthEngine::subBlockSize;
+
+        auto bank = std::make_unique<OscillatorBank>();
+        std::vector<float> buffer(static_cast<size_t>(OscillatorBank::maxLanes * blockSize));
+
+        bank->setSampleRate(sampleRate);
+        for (int lane = 0; lane < OscillatorBank::maxLanes; lane++)
+        {
+            const float freq = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(36 + lane));
+            bank->setFrequency(lane, freq, (freq / 2.0f));
+            bank->setLevels(lane, 0.05f, 0.02f);
+        }
+
+        for (int numVoices : voiceCounts)
+        {
+            const juce::String name = "bank/simd" + juce::String(OscillatorBank::getSimdWidth()) + "/voices" + juce::String(numVoices);
+            if (! isEnabled(name))
+            {
+                continue;
+            }
+
+            const juce::uint64 lanes = (64 <= numVoices) ? ~juce::uint64(0) : ((juce::uint64(1) << numVoices) - 1);
+            const double ns = measure([&]
+            {
+                bank->render(lanes, buffer.data(), blockSize, blockSize);
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult(name, ns, (numVoices * 1.0e9) / (ns * sampleRate));
+        }
+
+        // With unison on the voices only use the sub, which gets its own kernel
+        const juce::String subName = "bank/simd" + juce::String(OscillatorBank::getSimdWidth()) + "/voices64/sub-only";
+        if (isEnabled(subName))
+        {
+            for (int lane = 0; lane < OscillatorBank::maxLanes; lane++)
+            {
+                bank->setLevels(lane, 0.0f, 0.02f);
+            }
+
+            const double ns = measure([&]
+            {
+                bank->render(~juce::uint64(0), buffer.data(), blockSize, blockSize);
+                benchmarkSink = buffer[0];
+            }, blockSize);
+
+            addResult(subName, ns, (OscillatorBank::maxLanes * 1.0e9) / (ns * sampleRate));
+        }
+    }
+
+    // @brief       Function to time the FastMath approximations against libm, the
+    //              times are per value rather than per sample
+    // @param       None
+    void Benchmarks::runMath()
+    {
+        constexpr int numValues = 512;
+
+        std::vector<float> exponents(static_cast<size_t>(numValues));
+        std::vector<float> angles(static_cast<size_t>(numValues));
+        std::vector<float> prewarps(static_cast<size_t>(numValues));
+        std::vector<float> notes(static_cast<size_t>(numValues));
+        std::vector<float> output(static_cast<size_t>(numValues));
+
+        // Typical arguments: pitch and cutoff modulation, LFO phases, cutoffs up to 0.45 fs and bent notes
+        juce::Random random(1);
+        for (size_t i = 0; i < static_cast<size_t>(numValues); i++)
+        {
+            exponents[i]    = (random.nextFloat() * 8.0f) - 4.0f;
+            angles[i]       = (random.nextFloat() * 4.0f * juce::MathConstants<float>::pi) - (2.0f * juce::MathConstants<float>::pi);
+            prewarps[i]     = random.nextFloat() * 0.45f * juce::MathConstants<float>::pi;
+            notes[i]        = random.nextFloat() * 127.0f;
+        }
+
+        auto runCase = [this, &output](const juce::String& name, auto&& function)
+        {
+            if (! isEnabled(name))
+            {
+                return;
+            }
+
+            const double ns = measure([&]
+            {
+                function();
+                benchmarkSink = output[0];
+            }, numValues);
+
+            addResult(name, ns, 0.0);
+        };
+
+        runCase("math/exp2/libm", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = std::exp2(exponents[static_cast<size_t>(i)]);
+            }
+        });
+        runCase("math/exp2/fast", [&] { FastMath::exp2(exponents.data(), output.data(), numValues); });
+
+        runCase("math/sin/libm", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = std::sin(angles[static_cast<size_t>(i)]);
+            }
+        });
+        runCase("math/sin/fast", [&] { FastMath::sin(angles.data(), output.data(), numValues); });
+
+        runCase("math/tan/libm", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = std::tan(prewarps[static_cast<size_t>(i)]);
+            }
+        });
+        runCase("math/tan/juce", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = juce::dsp::FastMathApproximations::tan(prewarps[static_cast<size_t>(i)]);
+            }
+        });
+        runCase("math/tan/fast", [&] { FastMath::tan(prewarps.data(), output.data(), numValues); });
+
+        runCase("math/note/libm", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = 440.0f * std::pow(2.0f, ((notes[static_cast<size_t>(i)] - 69.0f) / 12.0f));
+            }
+        });
+        runCase("math/note/fast", [&]
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[static_cast<size_t>(i)] = FastMath::pitchToFrequency(notes[static_cast<size_t>(i)]);
+            }
+        });
+    }
+
+    // @brief       Function to time the analyser: what a block costs the audio thread,
+    //              and what a frame costs the thread that draws
+    // @param       None
+    void Benchmarks::runAnalyser()
+    {
+        constexpr int blockSize = 512;
+        constexpr int frameSize = 1600;         // One frame at 30Hz and 48kHz
+
+        auto analyser = std::make_unique<AudioAnalyser>();
+        std::vector<float> block(static_cast<size_t>(frameSize));
+
+        juce::Random random(1);
+        for (auto& sample : block)
+        {
+            sample = (random.nextFloat() * 2.0f) - 1.0f;
+        }
+
+        if (isEnabled("analyser/push"))
+        {
+            // Drained from another thread as it is in the app, so the queue doesn't fill
+            // up and turn the pushes into drops
+            std::atomic<bool> stop { false };
+            std::thread consumer([&]
+            {
+                while (! stop.load())
+                {
+                    analyser->update();
+                }
+            });
+
+            const double ns = measure([&]
+            {
+                analyser->push(block.data(), blockSize);
+            }, blockSize);
+
+            stop.store(true);
+            consumer.join();
+            addResult("analyser/push", ns, 0.0);
+        }
+
+        if (isEnabled("analyser/update"))
+        {
+            analyser->clear();
+
+            const double ns = measure([&]
+            {
+                analyser->push(block.data(), frameSize);
+                analyser->update();
+                benchmarkSink = analyser->getSpectrum()[1];
+            }, frameSize);
+
+            addResult("analyser/update", ns, 0.0);
+        }
+    }
+
+    // @brief       Function to time the whole engine, i.e. the audio callback
+    // @param       None
+    void Benchmarks::runEngine()
+    {
+        // Sweep one setting at a time around 48 kHz, 512 samples and 16 voices
+        for (int blockSize : blockSizes)
+        {
+            runEngineCase(48000.0, blockSize, 16, 0);
+        }
+        for (int numVoices : voiceCounts)
+        {
+            runEngineCase(48000.0, 512, numVoices, 0);
+        }
+        for (double sampleRate : sampleRates)
+        {
+            runEngineCase(sampleRate, 512, 16, 0);
+        }
+        for (int order = 1; order <= SynthEngine::maxOversamplingOrder; order++)
+        {
+            runEngineCase(48000.0, 512, 16, order);
+        }
+
+        // Nothing playing, the engine should skip straight through
+        runEngineCase(48000.0, 512, 0, 0);
+
+        // A full voice pool shared between threads
+        for (int numThreads = 1; numThreads <= SynthEngine::maxThreads; numThreads *= 2)
+        {
+            runEngineCase(48000.0, 512, SynthEngine::maxVoices, 0, numThreads);
+        }
+
+        // Vibrato, a filter sweep and tremolo on every voice, against the same case without
+        for (int interval = SynthEngine::minControlInterval; interval <= SynthEngine::subBlockSize; interval *= 2)
+        {
+            runEngineCase(48000.0, 512, SynthEngine::maxVoices, 0, 1, interval);
+        }
+    }
+
+    // @brief       Function to time the engine with one set of settings
+    // @param       sampleRate = Device sample rate
+    //              blockSize = Device block size
+    //              numVoices = Number of notes held
+    //              oversamplingOrder = Oversampling factor is 2^order
+    //              numThreads = Threads sharing the voices
+    //              controlInterval = Samples between modulation updates, 0 for no modulation
+    void Benchmarks::runEngineCase(double sampleRate, int blockSize, int numVoices, int oversamplingOrder, int numThreads,
+                                   int controlInterval)
+    {
+        juce::String name = "engine/" + juce::String(sampleRate / 1000.0, 1) + "k/block" + juce::String(blockSize)
+                          + "/voices" + juce::String(numVoices) + "/os" + juce::String(1 << oversamplingOrder) + "x";
+        if (1 < numThreads)
+        {
+            name += "/threads" + juce::String(numThreads);
+        }
+        if (0 < controlInterval)
+        {
+            name += "/mod" + juce::String(controlInterval);
+        }
+
+        // The sweeps share their centre case, only time it once
+        for (auto& result : _results)
+        {
+            if (result.name == name)
+            {
+                return;
+            }
+        }
+
+        if (! isEnabled(name))
+        {
+            return;
+        }
+
+        auto engine = std::make_unique<SynthEngine>();
+        juce::AudioBuffer<float> buffer(2, blockSize);
+
+        engine->setPolyphony(numVoices);
+        engine->setOversamplingOrder(oversamplingOrder);
+        engine->setNumThreads(numThreads);
+        if (0 < controlInterval)
+        {
+            engine->setControlInterval(controlInterval);
+            engine->setLfoRate(0, 5.0f);
+            engine->setLfoRate(1, 0.3f);
+            engine->setModulation(0, ModSource::lfo1, ModDestination::pitch, 0.02f);
+            engine->setModulation(1, ModSource::lfo2, ModDestination::filterCutoff, 0.5f);
+            engine->setModulation(2, ModSource::lfo1, ModDestination::level, 0.2f);
+        }
+        engine->prepare(sampleRate, blockSize, 2);
+
+        for (int voice = 0; voice < numVoices; voice++)
+        {
+            engine->noteOn((36 + voice), 0.8f);
+        }
+
+        const double ns = measure([&]
+        {
+            // Counted for the bench command to fail on (debug builds only)
+            ScopedAllocationTrap allocationTrap;
+            engine->renderNextBlock(buffer, 0, blockSize);
+            benchmarkSink = buffer.getSample(0, 0);
+        }, blockSize);
+
+        // Per core, so a perfect split across threads keeps the same figure
+        addResult(name, ns, (numVoices * 1.0e9) / (ns * sampleRate * numThreads));
+        engine->release();
+    }
+
+    // @brief       Function to check a case against the filter
+    // @param       name = Name of the case
+    bool Benchmarks::isEnabled(const juce::String& name) const
+    {
+        return _filter.isEmpty() || name.containsIgnoreCase(_filter);
+    }
+
+    // @brief       Function to record and print a result
+    // @param       name = Name of the case
+    //              nsPerSample = Time per output sample
+    //              voicesPerCore = Voices one core could render in real time, 0 if it doesn't apply
+    void Benchmarks::addResult(const juce::String& name, double nsPerSample, double voicesPerCore)
+    {
+        _results.push_back({ name, nsPerSample, voicesPerCore });
+
+        std::cout << name.paddedRight(' ', 40)
+                  << juce::String(nsPerSample, 3).paddedLeft(' ', 12)
+                  << ((0.0 < voicesPerCore) ? juce::String(voicesPerCore, 1) : juce::String("-")).paddedLeft(' ', 14)
+                  << std::endl;
+    }
+
+    // @brief       Function to time a piece of work
+    // @param       function = The work, called repeatedly
+    //              samplesPerCall = Number of output samples each call produces
+    template <typename Function>
+    double Benchmarks::measure(Function&& function, int samplesPerCall)
+    {
+        auto timeCalls = [&function](juce::int64 numCalls)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (juce::int64 call = 0; call < numCalls; call++)
+            {
+                function();
+            }
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        };
+
+        // Warm up the caches, then find how many calls it takes to fill the minimum time
+        juce::int64 numCalls = 1;
+        double seconds = timeCalls(numCalls);
+        while ((seconds < _minSeconds) && (numCalls < (juce::int64(1) << 30)))
+        {
+            numCalls    *= 2;
+            seconds     = timeCalls(numCalls);
+        }
+
+        double best = seconds;
+        for (int repetition = 1; repetition < _repetitions; repetition++)
+        {
+            best = juce::jmin(best, timeCalls(numCalls));
+        }
+
+        return (best * 1.0e9) / (static_cast<double>(numCalls) * samplesPerCall);
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created: 16 Nov 2024 10:41:05am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Micro benchmarks for the oscillators, noise, filters, envelope, unison, the
+    // whole engine, the FastMath approximations and the analyser feed. Every case
+    // is reported as nanoseconds per output sample (per value for the maths), and
+    // the voice based cases also as the number of voices one core could keep up
+    // with in real time. Each case runs for at least the minimum time and the
+    // fastest of a few repetitions is kept, which filters out scheduling noise.
+    class Benchmarks
+    {
+    public:
+        struct Result
+        {
+            juce::String    name;
+            double          nsPerSample     = 0.0;
+            double          voicesPerCore   = 0.0;      // 0 when it doesn't apply
+        };
+
+        Benchmarks(double minSeconds, int repetitions);
+        ~Benchmarks()
+        {
+
+        }
+
+        void            run(const juce::String& filter);
+        juce::String    toCsv(void) const;
+
+        const std::vector<Result>&  getResults(void) const      { return _results; }
+
+    private:
+        void            runOscillators(void);
+        void            runNoise(void);
+        void            runFilters(void);
+        void            runEnvelope(void);
+        void            runUnison(void);
+        void            runOscillatorBank(void);
+        void            runEngine(void);
+        void            runMath(void);
+        void            runAnalyser(void);
+        void            runEngineCase(double sampleRate, int blockSize, int numVoices, int oversamplingOrder, int numThreads = 1,
+                                      int controlInterval = 0);
+
+        bool            isEnabled(const juce::String& name) const;
+        void            addResult(const juce::String& name, double nsPerSample, double voicesPerCore);
+
+        template <typename Function>
+        double          measure(Function&& function, int samplesPerCall);
+
+        double                  _minSeconds;
+        int                     _repetitions;
+        juce::String            _filter;
+        std::vector<Result>     _results;
+
+        JUCE_DECLARE_NON_COPYABLE(Benchmarks)
+    };
+}
+//==============================================================================
\ No newline at end of file
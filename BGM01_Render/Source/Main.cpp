@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for a JUCE application.
+
+    Headless renderer for the BGM01 synth engine. Renders a MIDI file or a
+    note list to WAV faster than real time and reports the throughput.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "OfflineRenderer.h"
+#include "Benchmarks.h"
+#include "MathAccuracy.h"
+#include "../../BGM01_Synthesizer/Source/WavetableBank.h"
+#include "../../BGM01_Synthesizer/Source/AllocationGuard.h"
+
+//==============================================================================
+// @brief       Function to read the render settings from the command line
+// @param       args = The command line
+static BGM01::OfflineRenderer::Settings getSettings(const juce::ArgumentList& args)
+{
+    BGM01::OfflineRenderer::Settings settings;
+
+    if (args.containsOption("--rate"))
+    {
+        settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+    }
+    if (args.containsOption("--block"))
+    {
+        settings.blockSize = args.getValueForOption("--block").getIntValue();
+    }
+    if (args.containsOption("--channels"))
+    {
+        settings.numChannels = args.getValueForOption("--channels").getIntValue();
+    }
+    if (args.containsOption("--tail"))
+    {
+        settings.tailSeconds = args.getValueForOption("--tail").getDoubleValue();
+    }
+    if (args.containsOption("--seed"))
+    {
+        settings.noiseSeed = static_cast<juce::uint32>(args.getValueForOption("--seed").getLargeIntValue());
+    }
+    if (args.containsOption("--threads"))
+    {
+        settings.numThreads = args.getValueForOption("--threads").getIntValue();
+    }
+    if (args.containsOption("--oversampling"))
+    {
+        // Given as the factor, the engine wants the order
+        const int factor = args.getValueForOption("--oversampling").getIntValue();
+        if ((! juce::isPowerOfTwo(factor)) || (0 >= factor) || ((1 << BGM01::SynthEngine::maxOversamplingOrder) < factor))
+        {
+            juce::ConsoleApplication::fail("--oversampling must be 1, 2, 4 or 8");
+        }
+        settings.oversamplingOrder = juce::findHighestSetBit(static_cast<juce::uint32>(factor));
+    }
+
+    if ((8000.0 > settings.sampleRate) || (768000.0 < settings.sampleRate))
+    {
+        juce::ConsoleApplication::fail("--rate must be between 8000 and 768000");
+    }
+    if ((1 > settings.blockSize) || (65536 < settings.blockSize))
+    {
+        juce::ConsoleApplication::fail("--block must be between 1 and 65536");
+    }
+    if ((1 > settings.numChannels) || (BGM01::SynthEngine::maxChannels < settings.numChannels))
+    {
+        juce::ConsoleApplication::fail("--channels must be 1 or 2");
+    }
+    if (0.0 > settings.tailSeconds)
+    {
+        juce::ConsoleApplication::fail("--tail can't be negative");
+    }
+    if ((1 > settings.numThreads) || (BGM01::SynthEngine::maxThreads < settings.numThreads))
+    {
+        juce::ConsoleApplication::fail("--threads must be between 1 and " + juce::String(BGM01::SynthEngine::maxThreads));
+    }
+
+    return settings;
+}
+
+// @brief       Function to load the notes named on the command line
+// @param       args = The command line
+//              renderer = Renderer to load the notes into
+static void loadNotes(const juce::ArgumentList& args, BGM01::OfflineRenderer& renderer)
+{
+    juce::Result result = juce::Result::ok();
+
+    if (args.containsOption("--midi"))
+    {
+        result = renderer.loadMidiFile(args.getExistingFileForOption("--midi"));
+    }
+    else if (args.containsOption("--notes"))
+    {
+        result = renderer.loadNoteList(args.getValueForOption("--notes"));
+    }
+    else
+    {
+        juce::ConsoleApplication::fail("Nothing to render, give either --midi or --notes");
+    }
+
+    if (result.failed())
+    {
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+    }
+}
+
+// @brief       Function to fail the command if the engine allocated while it was rendering
+// @param       None
+// @note        Only debug builds trap allocations, release builds always pass
+static void checkAllocations()
+{
+    const int numAllocations = BGM01::ScopedAllocationTrap::getViolationCount();
+    if (0 < numAllocations)
+    {
+        juce::ConsoleApplication::fail(juce::String(numAllocations) + " heap allocations or frees on the real-time path");
+    }
+}
+
+// @brief       Function for the render command
+// @param       args = The command line
+static void renderCommand(const juce::ArgumentList& args)
+{
+    BGM01::OfflineRenderer renderer;
+    BGM01::OfflineRenderer::Stats stats;
+
+    const auto settings = getSettings(args);
+    loadNotes(args, renderer);
+
+    // Without an output file the audio is thrown away, which only times the engine
+    juce::Result result = juce::Result::ok();
+    if (args.containsOption("--output"))
+    {
+        result = renderer.renderToFile(settings, args.getFileForOption("--output"), stats);
+    }
+    else
+    {
+        result = renderer.render(settings, nullptr, stats);
+    }
+
+    if (result.failed())
+    {
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+    }
+
+    std::cout << "Rendered "            << juce::String(stats.audioSeconds, 2)
+              << " s of audio at "      << juce::String(settings.sampleRate, 0)
+              << " Hz, block "          << settings.blockSize
+              << ", threads "           << settings.numThreads
+              << ", oversampling "      << (1 << settings.oversamplingOrder) << "x" << std::endl
+              << "Engine time "         << juce::String(stats.cpuSeconds, 3) << " s CPU, "
+                                        << juce::String(stats.wallSeconds, 3) << " s wall" << std::endl
+              << "Silent "              << juce::String(stats.silentSeconds, 2) << " s skipped" << std::endl
+              << "Throughput "          << juce::String(stats.getAudioPerCpuSecond(), 1)
+              << " s of audio per CPU-second (" << juce::String(stats.getRealtimeFactor(), 1) << "x real time)" << std::endl;
+
+    checkAllocations();
+}
+
+// @brief       Function for the benchmark command
+// @param       args = The command line
+static void benchmarkCommand(const juce::ArgumentList& args)
+{
+    const bool quick = args.containsOption("--quick");
+    BGM01::Benchmarks benchmarks(quick ? 0.01 : 0.1, quick ? 1 : 3);
+
+    benchmarks.run(args.getValueForOption("--filter"));
+
+    if (args.containsOption("--csv"))
+    {
+        auto file = args.getFileForOption("--csv");
+        if (! file.replaceWithText(benchmarks.toCsv()))
+        {
+            juce::ConsoleApplication::fail("Could not write " + file.getFullPathName());
+        }
+    }
+
+    checkAllocations();
+}
+
+// @brief       Function for the wavetable command, writes the built in bank and maps it back
+// @param       args = The command line
+static void wavetablesCommand(const juce::ArgumentList& args)
+{
+    const auto file     = args.getFileForOption("--output");
+    const int tableSize = args.containsOption("--size") ? args.getValueForOption("--size").getIntValue()
+                                                        : BGM01::WavetableBank::defaultTableSize;
+
+    if ((! juce::isPowerOfTwo(tableSize)) || (BGM01::WavetableBank::minTableSize > tableSize) || (BGM01::WavetableBank::maxTableSize < tableSize))
+    {
+        juce::ConsoleApplication::fail("--size must be a power of two from " + juce::String(BGM01::WavetableBank::minTableSize)
+                                       + " to " + juce::String(BGM01::WavetableBank::maxTableSize));
+    }
+
+    BGM01::WavetableBank bank;
+    auto start = juce::Time::getHighResolutionTicks();
+    bank.createBasic(tableSize);
+    const double buildSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    auto result = bank.saveToFile(file);
+    if (result.failed())
+    {
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+    }
+
+    // Loading only checks the header, the samples are paged in as they're read
+    BGM01::WavetableBank mapped;
+    start = juce::Time::getHighResolutionTicks();
+    result = mapped.loadFromFile(file);
+    const double mapSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    if (result.failed())
+    {
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+    }
+
+    std::cout << "Wrote "           << mapped.getNumTables() << " tables of " << mapped.getTableSize()
+              << " samples with "   << mapped.getNumLevels() << " mip levels to " << file.getFullPathName() << std::endl
+              << "Built in "        << juce::String(buildSeconds * 1000.0, 3) << " ms, mapped in "
+                                    << juce::String(mapSeconds * 1000.0, 3) << " ms" << std::endl;
+}
+
+// @brief       Function for the maths command, checks the FastMath errors and times them against libm
+// @param       args = The command line
+static void mathCommand(const juce::ArgumentList& args)
+{
+    const bool quick = args.containsOption("--quick");
+
+    BGM01::MathAccuracy accuracy;
+    const bool accurate = accuracy.run(quick ? 100000 : 4000000);
+    std::cout << std::endl;
+
+    BGM01::Benchmarks benchmarks(quick ? 0.01 : 0.1, quick ? 1 : 3);
+    benchmarks.run("math/");
+    std::cout << std::endl;
+
+    // Every function has a libm case and a fast case next to it
+    for (auto& reference : benchmarks.getResults())
+    {
+        if (! reference.name.endsWith("/libm"))
+        {
+            continue;
+        }
+
+        const auto function = reference.name.dropLastCharacters(5);
+        for (auto& fast : benchmarks.getResults())
+        {
+            if ((function + "/fast") == fast.name)
+            {
+                std::cout << function.paddedRight(' ', 40)
+                          << (juce::String(reference.nsPerSample / fast.nsPerSample, 1) + "x faster").paddedLeft(' ', 14) << std::endl;
+            }
+        }
+    }
+
+    if (! accurate)
+    {
+        juce::ConsoleApplication::fail("FastMath is outside its error limits");
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand("--help|-h", "BGM01_Render, offline renderer for the BGM01 synth", false);
+    app.addDefaultCommand({ "--render",
+                            "[--render] (--midi=<file.mid> | --notes=<note:start:length[:velocity],...>) [options]",
+                            "Renders notes through the synth engine",
+                            "Options:\n"
+                            "  --output=<file.wav>      Write 24 bit WAV, otherwise the engine is only timed\n"
+                            "  --rate=<hz>              Sample rate (default 48000)\n"
+                            "  --block=<samples>        Block size (default 512)\n"
+                            "  --channels=<1|2>         Output channels (default 2)\n"
+                            "  --oversampling=<1|2|4|8> Oversampling factor (default 1)\n"
+                            "  --threads=<count>        Threads sharing the voices, 1 to 8 (default 1)\n"
+                            "  --tail=<seconds>         Render time after the last event (default 1)\n"
+                            "  --seed=<number>          Noise seed, the same seed gives the same render (default 1)",
+                            renderCommand });
+    app.addCommand({ "--benchmark",
+                     "--benchmark [--filter=<text>] [--quick] [--csv=<file>]",
+                     "Times the oscillators, filters and engine",
+                     "Reports ns per output sample and, for voice based cases, how many voices\n"
+                     "one core can render in real time. --filter only runs the cases with the\n"
+                     "text in their name, --quick trades accuracy for time and --csv saves the\n"
+                     "results for comparing against another build.",
+                     benchmarkCommand });
+    app.addCommand({ "--wavetables",
+                     "--wavetables --output=<file.bgwt> [--size=<samples>]",
+                     "Writes the built in wavetable bank",
+                     "Builds the sine, triangle, saw and square tables with their band limited\n"
+                     "mip levels, writes them in the memory mapped .bgwt format and maps the\n"
+                     "file back to check it. --size is the samples per cycle (default 2048).",
+                     wavetablesCommand });
+    app.addCommand({ "--math",
+                     "--math [--quick]",
+                     "Checks and times the FastMath approximations",
+                     "Sweeps each approximation against libm, reporting its worst error and\n"
+                     "failing if any is above the limit FastMath.h documents, then times each\n"
+                     "one against the libm call it replaces. --quick checks fewer points.",
+                     mathCommand });
+
+    return app.findAndRunCommand(argc, argv);
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    MathAccuracy.cpp
+    Created: 18 Jan 2025 2:15:40pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "MathAccuracy.h"
+#include <iostream>
+#include "../../BGM01_Synthesizer/Source/FastMath.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor
+    MathAccuracy::MathAccuracy()
+    {
+        _numPoints = 0;
+    }
+
+    // @brief       Function to check every approximation and print the errors
+    // @param       numPoints = Inputs tried per function, spread evenly over its range
+    // @return      True if every function is within its limit
+    bool MathAccuracy::run(int numPoints)
+    {
+        _numPoints = juce::jmax(2, numPoints);
+        _results.clear();
+
+        std::cout << juce::String("function").paddedRight(' ', 32)
+                  << juce::String("max error").paddedLeft(' ', 14)
+                  << juce::String("at").paddedLeft(' ', 14)
+                  << juce::String("limit").paddedLeft(' ', 12) << std::endl;
+
+        const double pi = juce::MathConstants<double>::pi;
+
+        check("exp2", -126.0, 127.0, 2.0e-7, true,
+              [](float x) { return FastMath::exp2(x); }, [](double x) { return std::exp2(x); });
+        check("exp2/pitch", -4.0, 4.0, 2.0e-7, true,
+              [](float x) { return FastMath::exp2(x); }, [](double x) { return std::exp2(x); });
+        check("sin", -2.0 * pi, 2.0 * pi, 1.0e-6, false,
+              [](float x) { return FastMath::sin(x); }, [](double x) { return std::sin(x); });
+        check("sinCycles", -4.0, 4.0, 1.0e-6, false,
+              [](float x) { return FastMath::sinCycles(x); }, [pi](double x) { return std::sin(2.0 * pi * x); });
+
+        // The filter prewarp goes up to 0.45 of the sample rate, the full range is
+        // checked too since the reflection about pi/4 is the delicate part
+        check("tan/cutoff", 0.0, 0.45 * pi, 1.0e-6, true,
+              [](float x) { return FastMath::tan(x); }, [](double x) { return std::tan(x); });
+        check("tan", -0.4999 * pi, 0.4999 * pi, 1.0e-6, true,
+              [](float x) { return FastMath::tan(x); }, [](double x) { return std::tan(x); });
+
+        check("pitchToFrequency", 0.0, 127.0, 1.0e-6, true,
+              [](float note) { return FastMath::pitchToFrequency(note); },
+              [](double note) { return 440.0 * std::exp2((note - 69.0) / 12.0); });
+        check("semitonesToRatio", -48.0, 48.0, 2.0e-7, true,
+              [](float semitones) { return FastMath::semitonesToRatio(semitones); },
+              [](double semitones) { return std::exp2(semitones / 12.0); });
+
+        bool passed = true;
+        for (auto& result : _results)
+        {
+            passed = passed && result.passed();
+        }
+
+        return passed;
+    }
+
+    // @brief       Function to sweep one approximation and record its worst error
+    // @param       name = Name of the check
+    //              start = First input
+    //              end = Last input
+    //              limit = Largest error allowed
+    //              relative = True to measure the error relative to the exact value
+    //              approximation = The FastMath function
+    //              exact = The libm function, in double precision
+    template <typename Approximation, typename Exact>
+    void MathAccuracy::check(const juce::String& name, double start, double end, double limit, bool relative,
+                             Approximation&& approximation, Exact&& exact)
+    {
+        Result result;
+        result.name     = name;
+        result.limit    = limit;
+        result.relative = relative;
+
+        for (int point = 0; point < _numPoints; point++)
+        {
+            // The float input is what the approximation sees, so that is what the exact value is taken at
+            const float input   = static_cast<float>(start + ((end - start) * point) / (_numPoints - 1));
+            const double wanted = exact(static_cast<double>(input));
+            double error        = std::abs(static_cast<double>(approximation(input)) - wanted);
+
+            if (relative && (0.0 != wanted))
+            {
+                error /= std::abs(wanted);
+            }
+
+            if (error > result.maxError)
+            {
+                result.maxError     = error;
+                result.worstInput   = input;
+            }
+        }
+
+        _results.push_back(result);
+
+        std::cout << name.paddedRight(' ', 32)
+                  << (juce::String(result.maxError, 3, true) + (relative ? " rel" : " abs")).paddedLeft(' ', 14)
+                  << juce::String(result.worstInput, 4).paddedLeft(' ', 14)
+                  << juce::String(limit, 1, true).paddedLeft(' ', 12)
+                  << (result.passed() ? "" : "  FAILED") << std::endl;
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    MathAccuracy.h
+    Created: 18 Jan 2025 2:15:40pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Checks the FastMath approximations against libm in double precision. Each
+    // function is swept densely over the range the synth uses it for and its
+    // worst error is compared with the limit FastMath.h promises, so a change
+    // to a polynomial that loses accuracy fails the check.
+    class MathAccuracy
+    {
+    public:
+        struct Result
+        {
+            juce::String    name;
+            double          maxError        = 0.0;
+            double          worstInput      = 0.0;
+            double          limit           = 0.0;
+            bool            relative        = false;    // Error relative to the exact value
+
+            bool            passed(void) const          { return maxError <= limit; }
+        };
+
+        MathAccuracy();
+        ~MathAccuracy()
+        {
+
+        }
+
+        bool    run(int numPoints);
+
+        const std::vector<Result>&  getResults(void) const      { return _results; }
+
+    private:
+        template <typename Approximation, typename Exact>
+        void    check(const juce::String& name, double start, double end, double limit, bool relative,
+                      Approximation&& approximation, Exact&& exact);
+
+        std::vector<Result>     _results;
+        int                     _numPoints;
+    };
+}
+//==============================================================================
\ No newline at end of file
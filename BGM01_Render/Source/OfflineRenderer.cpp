@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 9 Nov 2024 1:36:52pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include <ctime>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor
+    OfflineRenderer::OfflineRenderer() : _engine(std::make_unique<SynthEngine>())
+    {
+
+    }
+
+    // @brief       Function to load the notes to render from a standard MIDI file
+    // @param       file = The MIDI file, all tracks are merged
+    juce::Result OfflineRenderer::loadMidiFile(const juce::File& file)
+    {
+        juce::FileInputStream stream(file);
+        if (! stream.openedOk())
+        {
+            return juce::Result::fail("Could not open " + file.getFullPathName());
+        }
+
+        juce::MidiFile midiFile;
+        if (! midiFile.readFrom(stream))
+        {
+            return juce::Result::fail(file.getFullPathName() + " is not a valid MIDI file");
+        }
+        midiFile.convertTimestampTicksToSeconds();
+
+        _sequence.clear();
+        for (int track = 0; track < midiFile.getNumTracks(); track++)
+        {
+            _sequence.addSequence(*midiFile.getTrack(track), 0.0);
+        }
+        _sequence.updateMatchedPairs();
+
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to load the notes to render from a list
+    // @param       notes = Comma separated notes as note:start:length[:velocity],
+    //                      with times in seconds and velocity from 0 to 1
+    juce::Result OfflineRenderer::loadNoteList(const juce::String& notes)
+    {
+        _sequence.clear();
+
+        for (auto& note : juce::StringArray::fromTokens(notes, ",", ""))
+        {
+            auto fields = juce::StringArray::fromTokens(note.trim(), ":", "");
+            if ((3 > fields.size()) || (4 < fields.size()))
+            {
+                return juce::Result::fail("Expected note:start:length[:velocity] but got '" + note + "'");
+            }
+
+            const int number        = fields[0].getIntValue();
+            const double start      = fields[1].getDoubleValue();
+            const double length     = fields[2].getDoubleValue();
+            const float velocity    = (4 == fields.size()) ? fields[3].getFloatValue() : 0.8f;
+
+            if ((0 > number) || (127 < number) || (0.0 > start) || (0.0 >= length))
+            {
+                return juce::Result::fail("Note '" + note + "' is out of range");
+            }
+
+            _sequence.addEvent(juce::MidiMessage::noteOn(1, number, velocity), start);
+            _sequence.addEvent(juce::MidiMessage::noteOff(1, number), (start + length));
+        }
+
+        _sequence.sort();
+        _sequence.updateMatchedPairs();
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to get the time of the last event
+    // @param       None
+    double OfflineRenderer::getSequenceLength() const
+    {
+        return _sequence.getEndTime();
+    }
+
+    // @brief       Function to render the loaded notes
+    // @param       settings = How to render
+    //              writer = Where to write the audio, nullptr to only time the engine
+    //              stats = Filled in with the amount of audio and time taken
+    juce::Result OfflineRenderer::render(const Settings& settings, juce::AudioFormatWriter* writer, Stats& stats)
+    {
+        if ((0.0 >= settings.sampleRate) || (0 >= settings.blockSize))
+        {
+            return juce::Result::fail("The sample rate and block size must be positive");
+        }
+
+        auto& engine = *_engine;
+        engine.setOversamplingOrder(settings.oversamplingOrder);
+        engine.setNoiseSeed(settings.noiseSeed);
+        engine.setNumThreads(settings.numThreads);
+        engine.prepare(settings.sampleRate, settings.blockSize, settings.numChannels);
+        engine.allNotesOff();
+
+        juce::AudioBuffer<float> buffer(settings.numChannels, settings.blockSize);
+        _midiBuffer.ensureSize(4096);
+
+        const auto totalSamples = static_cast<juce::int64>(std::ceil((getSequenceLength() + settings.tailSeconds) * settings.sampleRate));
+        const int numEvents     = _sequence.getNumEvents();
+        int nextEvent           = 0;
+
+        stats = Stats();
+
+        for (juce::int64 position = 0; position < totalSamples; position += settings.blockSize)
+        {
+            const int blockSize = static_cast<int>(juce::jmin(static_cast<juce::int64>(settings.blockSize), (totalSamples - position)));
+
+            const auto startTicks   = juce::Time::getHighResolutionTicks();
+            const auto startClock   = std::clock();
+            bool audible            = false;
+
+            {
+                // Everything up to the file write is what an audio callback would do,
+                // so it must not allocate (debug builds only)
+                ScopedAllocationTrap allocationTrap;
+
+                // Hand the block's events to the engine at their sample positions
+                _midiBuffer.clear();
+                while (nextEvent < numEvents)
+                {
+                    const auto& message     = _sequence.getEventPointer(nextEvent)->message;
+                    const auto eventSample  = static_cast<juce::int64>(message.getTimeStamp() * settings.sampleRate);
+                    if (eventSample >= (position + blockSize))
+                    {
+                        break;
+                    }
+
+                    _midiBuffer.addEvent(message, static_cast<int>(juce::jmax(juce::int64(0), (eventSample - position))));
+                    nextEvent++;
+                }
+
+                audible = engine.renderNextBlock(buffer, _midiBuffer, 0, blockSize);
+            }
+
+            stats.wallSeconds   += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+            stats.cpuSeconds    += static_cast<double>(std::clock() - startClock) / CLOCKS_PER_SEC;
+
+            if (! audible)
+            {
+                stats.silentSeconds += blockSize / settings.sampleRate;
+            }
+
+            if ((nullptr != writer) && (! writer->writeFromAudioSampleBuffer(buffer, 0, blockSize)))
+            {
+                return juce::Result::fail("Could not write the rendered audio");
+            }
+        }
+
+        stats.audioSeconds = static_cast<double>(totalSamples) / settings.sampleRate;
+        engine.release();
+
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to render the loaded notes to a 24 bit WAV file
+    // @param       settings = How to render
+    //              file = The file to write, replaced if it exists
+    //              stats = Filled in with the amount of audio and time taken
+    juce::Result OfflineRenderer::renderToFile(const Settings& settings, const juce::File& file, Stats& stats)
+    {
+        // Render next to the target and only replace it once the whole file is written,
+        // so a failed render leaves any earlier file in place
+        juce::TemporaryFile temp(file);
+
+        auto stream = std::make_unique<juce::FileOutputStream>(temp.getFile());
+        if (! stream->openedOk())
+        {
+            return juce::Result::fail("Could not create " + temp.getFile().getFullPathName());
+        }
+
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), settings.sampleRate,
+                                                        static_cast<unsigned int>(settings.numChannels), 24, {}, 0));
+        if (nullptr == writer)
+        {
+            return juce::Result::fail("Could not create a WAV writer for " + file.getFullPathName());
+        }
+
+        // The writer owns the stream now
+        stream.release();
+
+        const auto result = render(settings, writer.get(), stats);
+
+        // Deleting the writer finishes the WAV header and closes the file
+        writer.reset();
+
+        if (result.failed())
+        {
+            return result;
+        }
+        if (! temp.overwriteTargetFileWithTemporary())
+        {
+            return juce::Result::fail("Could not replace " + file.getFullPathName());
+        }
+        return juce::Result::ok();
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 9 Nov 2024 1:36:52pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../BGM01_Synthesizer/Source/SynthEngine.h"
+#include "../../BGM01_Synthesizer/Source/AllocationGuard.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Renders a note sequence through the synth engine as fast as possible,
+    // without an audio device. Used for batch bouncing and for measuring how
+    // much audio the engine gets through per second of CPU time.
+    class OfflineRenderer
+    {
+    public:
+        struct Settings
+        {
+            double  sampleRate          = 48000.0;
+            int     blockSize           = 512;
+            int     numChannels         = 2;
+            int     oversamplingOrder   = 0;        // Factor is 2^order
+            int     numThreads          = 1;        // Including the calling thread
+            double  tailSeconds         = 1.0;      // Rendered after the last event
+            juce::uint32 noiseSeed      = 1;        // Same seed, same noise in every render
+        };
+
+        struct Stats
+        {
+            double  audioSeconds        = 0.0;
+            double  wallSeconds         = 0.0;      // Time spent in the engine only
+            double  cpuSeconds          = 0.0;      // CPU time spent in the engine only
+            double  silentSeconds       = 0.0;      // Audio the engine skipped as silent
+
+            double  getAudioPerCpuSecond(void) const    { return (0.0 < cpuSeconds) ? (audioSeconds / cpuSeconds) : 0.0; }
+            double  getRealtimeFactor(void) const       { return (0.0 < wallSeconds) ? (audioSeconds / wallSeconds) : 0.0; }
+        };
+
+        OfflineRenderer();
+        ~OfflineRenderer()
+        {
+
+        }
+
+        juce::Result    loadMidiFile(const juce::File& file);
+        juce::Result    loadNoteList(const juce::String& notes);
+
+        juce::Result    render(const Settings& settings, juce::AudioFormatWriter* writer, Stats& stats);
+        juce::Result    renderToFile(const Settings& settings, const juce::File& file, Stats& stats);
+
+        double          getSequenceLength(void) const;
+        SynthEngine&    getEngine(void)                 { return *_engine; }
+
+    private:
+        // Event times are in seconds
+        juce::MidiMessageSequence       _sequence;
+        juce::MidiBuffer                _midiBuffer;
+
+        // Heap allocated, the voice state is too large for the stack
+        std::unique_ptr<SynthEngine>    _engine;
+
+        JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+    };
+}
+//==============================================================================
\ No newline at end of file
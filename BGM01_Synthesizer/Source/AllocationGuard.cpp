@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    AllocationGuard.cpp
+    Created: 12 Oct 2024 10:02:15am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "AllocationGuard.h"
+#include <cstdlib>
+#include <new>
+
+#if BGM01_ALLOCATION_TRAP_MALLOC
+// glibc's own allocator, for the malloc replacements to pass on to
+extern "C"
+{
+    void*   __libc_malloc(std::size_t size);
+    void*   __libc_calloc(std::size_t count, std::size_t size);
+    void*   __libc_realloc(void* ptr, std::size_t size);
+    void    __libc_free(void* ptr);
+}
+#endif
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    namespace
+    {
+        // Nesting depth of traps on this thread, negative while a violation is reported
+        thread_local int    trapDepth = 0;
+        std::atomic<int>    violationCount { 0 };
+    }
+
+    // @brief       Constructor, arms the trap for the current thread
+    ScopedAllocationTrap::ScopedAllocationTrap()
+    {
+        if (0 <= trapDepth)
+        {
+            trapDepth++;
+        }
+    }
+
+    // @brief       Destructor, disarms the trap for the current thread
+    ScopedAllocationTrap::~ScopedAllocationTrap()
+    {
+        if (0 < trapDepth)
+        {
+            trapDepth--;
+        }
+    }
+
+    // @brief       Function to check if the trap is armed on the current thread
+    // @param       None
+    bool ScopedAllocationTrap::isArmed()
+    {
+        return (BGM01_ALLOCATION_TRAP && (0 < trapDepth));
+    }
+
+    // @brief       Function to get the number of allocations caught since the last reset
+    // @param       None
+    int ScopedAllocationTrap::getViolationCount()
+    {
+        return violationCount.load(std::memory_order_relaxed);
+    }
+
+    // @brief       Function to reset the number of allocations caught
+    // @param       None
+    void ScopedAllocationTrap::resetViolationCount()
+    {
+        violationCount.store(0, std::memory_order_relaxed);
+    }
+
+#if BGM01_ALLOCATION_TRAP
+    // @brief       Function called by the operator new/delete replacements
+    // @param       None
+    static void checkAllocation()
+    {
+        if (0 < trapDepth)
+        {
+            violationCount.fetch_add(1, std::memory_order_relaxed);
+
+            // Disarm while reporting, as the assertion itself may allocate
+            const int depth = trapDepth;
+            trapDepth = -1;
+            jassertfalse;   // Heap allocation on a real-time thread
+            trapDepth = depth;
+        }
+    }
+
+    // @brief       Function that does the actual allocation for the replacements
+    // @param       size = Number of bytes to allocate
+    static void* trappedAlloc(std::size_t size) noexcept
+    {
+        checkAllocation();
+       #if BGM01_ALLOCATION_TRAP_MALLOC
+        return __libc_malloc((0 < size) ? size : 1);
+       #else
+        return std::malloc((0 < size) ? size : 1);
+       #endif
+    }
+
+    // @brief       Function that does the actual free for the replacements
+    // @param       ptr = Memory to free
+    static void trappedFree(void* ptr) noexcept
+    {
+        if (nullptr != ptr)
+        {
+            checkAllocation();
+           #if BGM01_ALLOCATION_TRAP_MALLOC
+            __libc_free(ptr);
+           #else
+            std::free(ptr);
+           #endif
+        }
+    }
+#endif
+}
+
+#if BGM01_ALLOCATION_TRAP
+//==============================================================================
+// Global operator new/delete replacements, the aligned overloads are left to the
+// standard library as they are never used by the synth
+void* operator new(std::size_t size)
+{
+    if (void* ptr = BGM01::trappedAlloc(size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return BGM01::trappedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return BGM01::trappedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept                                    { BGM01::trappedFree(ptr); }
+void operator delete[](void* ptr) noexcept                                  { BGM01::trappedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept                       { BGM01::trappedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept                     { BGM01::trappedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept             { BGM01::trappedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept           { BGM01::trappedFree(ptr); }
+#endif
+
+#if BGM01_ALLOCATION_TRAP_MALLOC
+//==============================================================================
+// C allocator replacements, these catch juce::HeapBlock and everything built on
+// it (AudioBuffer, MidiBuffer, Array)
+extern "C"
+{
+    void* malloc(std::size_t size)
+    {
+        return BGM01::trappedAlloc(size);
+    }
+
+    void* calloc(std::size_t count, std::size_t size)
+    {
+        BGM01::checkAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, std::size_t size)
+    {
+        BGM01::checkAllocation();
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr)
+    {
+        BGM01::trappedFree(ptr);
+    }
+}
+#endif
+//==============================================================================
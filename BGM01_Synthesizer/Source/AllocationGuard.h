@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    AllocationGuard.h
+    Created: 12 Oct 2024 10:02:15am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The allocation trap replaces the global operator new/delete, and with glibc
+// malloc, calloc, realloc and free as well, so it is only enabled in debug
+// builds unless explicitly switched on or off
+#ifndef BGM01_ALLOCATION_TRAP
+ #if JUCE_DEBUG
+  #define BGM01_ALLOCATION_TRAP 1
+ #else
+  #define BGM01_ALLOCATION_TRAP 0
+ #endif
+#endif
+
+// JUCE's buffers allocate with malloc and realloc rather than new. glibc lets a
+// program replace those and still reach its own, other C libraries don't.
+#if BGM01_ALLOCATION_TRAP && defined(__GLIBC__)
+ #define BGM01_ALLOCATION_TRAP_MALLOC 1
+#else
+ #define BGM01_ALLOCATION_TRAP_MALLOC 0
+#endif
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Scoped trap that flags every heap allocation or free made on the current
+    // thread while it is alive. Put one at the top of the audio callback, and
+    // around anything else that must be real-time safe. Each one caught asserts
+    // and is counted, so tools can fail when getViolationCount is not 0.
+    class ScopedAllocationTrap
+    {
+    public:
+        ScopedAllocationTrap();
+        ~ScopedAllocationTrap();
+
+        static bool isArmed(void);
+        static int  getViolationCount(void);
+        static void resetViolationCount(void);
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllocationTrap)
+    };
+}
+//==============================================================================
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    AnalyserComponent.cpp
+    Created: 25 Jan 2025 10:21:46am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "AnalyserComponent.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, starts polling the analyser
+    // @param       analyser = Where the samples come from, must outlive the component
+    AnalyserComponent::AnalyserComponent(AudioAnalyser& analyser) : _analyser(analyser)
+    {
+        _numIdle = idleFrames;
+
+        // Fills its whole area, so nothing behind it is repainted with it
+        setOpaque(true);
+        startTimerHz(frameRate);
+    }
+
+    // @brief       Function to draw the views, the paths are already built
+    // @param       g = Graphics context
+    void AnalyserComponent::paint(juce::Graphics& g)
+    {
+        g.fillAll(juce::Colours::black);
+
+        g.setColour(juce::Colours::darkgrey);
+        g.drawRect(_scopeArea);
+        g.drawRect(_spectrumArea);
+        g.drawHorizontalLine(juce::roundToInt(_scopeArea.getCentreY()), _scopeArea.getX(), _scopeArea.getRight());
+
+        g.setColour(juce::Colours::limegreen);
+        g.strokePath(_scopePath, juce::PathStrokeType(1.0f));
+
+        g.setColour(juce::Colours::orange);
+        g.strokePath(_spectrumPath, juce::PathStrokeType(1.0f));
+    }
+
+    // @brief       Function to lay out the two views side by side
+    // @param       None
+    void AnalyserComponent::resized()
+    {
+        auto area       = getLocalBounds().toFloat().reduced(3.0f);
+        _scopeArea      = area.removeFromLeft(area.getWidth() / 2.0f).withTrimmedRight(3.0f);
+        _spectrumArea   = area.withTrimmedLeft(3.0f);
+
+        buildScopePath();
+        buildSpectrumPath();
+    }
+
+    // @brief       Function to take in new samples at the frame rate
+    // @param       None
+    void AnalyserComponent::timerCallback()
+    {
+        // Always drained, even when hidden, so the audio thread never finds the queue full
+        if (_analyser.update())
+        {
+            _numIdle = 0;
+            refresh();
+        }
+        else if (idleFrames == ++_numIdle)
+        {
+            // The engine stops pushing when it goes silent, flatten the views once
+            _analyser.clear();
+            refresh();
+        }
+        else
+        {
+            _numIdle = juce::jmin(_numIdle, idleFrames);
+        }
+    }
+
+    // @brief       Function to rebuild the paths and repaint just the two views
+    // @param       None
+    void AnalyserComponent::refresh()
+    {
+        if (! isShowing())
+        {
+            return;
+        }
+
+        buildScopePath();
+        buildSpectrumPath();
+        repaint(_scopeArea.getSmallestIntegerContainer());
+        repaint(_spectrumArea.getSmallestIntegerContainer());
+    }
+
+    // @brief       Function to build the scope trace, at most one point per pixel
+    // @param       None
+    void AnalyserComponent::buildScopePath()
+    {
+        _scopePath.clear();
+        if (_scopeArea.isEmpty())
+        {
+            return;
+        }
+
+        const float* scope      = _analyser.getScope();
+        const int numPoints     = juce::jmin(AudioAnalyser::scopeSize, juce::roundToInt(_scopeArea.getWidth()));
+        const float halfHeight  = _scopeArea.getHeight() / 2.0f;
+
+        for (int point = 0; point < numPoints; point++)
+        {
+            const int sample    = (point * AudioAnalyser::scopeSize) / numPoints;
+            const float x       = _scopeArea.getX() + ((point * _scopeArea.getWidth()) / juce::jmax(1, (numPoints - 1)));
+            const float y       = _scopeArea.getCentreY() - (juce::jlimit(-1.0f, 1.0f, scope[sample]) * halfHeight);
+
+            if (0 == point)
+            {
+                _scopePath.startNewSubPath(x, y);
+            }
+            else
+            {
+                _scopePath.lineTo(x, y);
+            }
+        }
+    }
+
+    // @brief       Function to build the spectrum trace, on a log frequency axis
+    //              from minFrequency to Nyquist with the loudest bin in each pixel
+    // @param       None
+    void AnalyserComponent::buildSpectrumPath()
+    {
+        _spectrumPath.clear();
+        if (_spectrumArea.isEmpty())
+        {
+            return;
+        }
+
+        const float* spectrum   = _analyser.getSpectrum();
+        const float binWidth    = static_cast<float>(_analyser.getSampleRate()) / static_cast<float>(AudioAnalyser::fftSize);
+        const float nyquist     = binWidth * static_cast<float>(AudioAnalyser::numBins);
+        const float octaves     = std::log2(nyquist / minFrequency);
+        const int numPoints     = juce::roundToInt(_spectrumArea.getWidth());
+
+        int bin = juce::jmax(1, static_cast<int>(minFrequency / binWidth));
+
+        for (int point = 0; point < numPoints; point++)
+        {
+            // Last bin under the right hand edge of this pixel, at least one bin per pixel
+            const float edge    = minFrequency * std::exp2((octaves * static_cast<float>(point + 1)) / static_cast<float>(numPoints));
+            const int lastBin   = juce::jlimit(bin, (AudioAnalyser::numBins - 1), static_cast<int>(edge / binWidth));
+
+            float level = AudioAnalyser::minDecibels;
+            for (; bin <= lastBin; bin++)
+            {
+                level = juce::jmax(level, spectrum[bin]);
+            }
+            bin = juce::jmin(bin, (AudioAnalyser::numBins - 1));
+
+            const float x = _spectrumArea.getX() + static_cast<float>(point);
+            const float y = juce::jmap(level, AudioAnalyser::minDecibels, 0.0f, _spectrumArea.getBottom(), _spectrumArea.getY());
+
+            if (0 == point)
+            {
+                _spectrumPath.startNewSubPath(x, y);
+            }
+            else
+            {
+                _spectrumPath.lineTo(x, y);
+            }
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    AnalyserComponent.h
+    Created: 25 Jan 2025 10:21:46am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioAnalyser.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Oscilloscope on the left and spectrum on the right, drawn from an
+    // AudioAnalyser. A timer on the message thread takes in the new samples
+    // and builds both paths at most frameRate times a second, so paint only
+    // strokes them. Only a view whose contents changed is repainted, and once
+    // the audio has stopped coming both are flattened and left alone.
+    class AnalyserComponent : public juce::Component,
+                              private juce::Timer
+    {
+    public:
+        static constexpr int    frameRate       = 30;
+
+        // Frames without new samples before the views are flattened
+        static constexpr int    idleFrames      = 5;
+
+        static constexpr float  minFrequency    = 20.0f;
+
+        explicit AnalyserComponent(AudioAnalyser& analyser);
+        ~AnalyserComponent() override
+        {
+
+        }
+
+        void    paint(juce::Graphics& g) override;
+        void    resized(void) override;
+
+    private:
+        void    timerCallback(void) override;
+        void    buildScopePath(void);
+        void    buildSpectrumPath(void);
+        void    refresh(void);
+
+        AudioAnalyser&          _analyser;
+        juce::Rectangle<float>  _scopeArea;
+        juce::Rectangle<float>  _spectrumArea;
+        juce::Path              _scopePath;
+        juce::Path              _spectrumPath;
+        int                     _numIdle;
+
+        JUCE_DECLARE_NON_COPYABLE(AnalyserComponent)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.cpp
+    Created: 25 Jan 2025 10:21:46am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "AudioAnalyser.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, allocates everything up front
+    AudioAnalyser::AudioAnalyser() :    _fifo(fifoSize),
+                                        _history(static_cast<size_t>(fftSize), 0.0f),
+                                        _linear(static_cast<size_t>(fftSize), 0.0f),
+                                        _fft(fftOrder),
+                                        _window(static_cast<size_t>(fftSize), juce::dsp::WindowingFunction<float>::hann, false),
+                                        _fftData(static_cast<size_t>(2 * fftSize), 0.0f),
+                                        _scope(static_cast<size_t>(scopeSize), 0.0f),
+                                        _spectrum(static_cast<size_t>(numBins), minDecibels)
+    {
+        _sampleRate         = 44100.0;
+        _numDropped         = 0;
+        _historyPosition    = 0;
+    }
+
+    // @brief       Function to hand a block of output to the analyser
+    // @param       samples = The samples, copied straight away
+    //              numSamples = Number of samples
+    // @note        Audio thread only. Wait-free, samples that don't fit are dropped.
+    void AudioAnalyser::push(const float* samples, int numSamples)
+    {
+        const int numPushed = _fifo.push(samples, numSamples);
+        if (numPushed < numSamples)
+        {
+            _numDropped.fetch_add((numSamples - numPushed), std::memory_order_relaxed);
+        }
+    }
+
+    // @brief       Function to take in what the audio thread has pushed and redo the views
+    // @param       None
+    // @return      False if nothing new arrived, the views are unchanged
+    bool AudioAnalyser::update()
+    {
+        bool received = false;
+
+        // Straight into the ring, anything older than the ring is simply written over
+        for (;;)
+        {
+            const int numRead = _fifo.pop((_history.data() + _historyPosition), (fftSize - _historyPosition));
+            if (0 == numRead)
+            {
+                break;
+            }
+
+            _historyPosition    = (_historyPosition + numRead) % fftSize;
+            received            = true;
+        }
+
+        if (! received)
+        {
+            return false;
+        }
+
+        std::copy((_history.begin() + _historyPosition), _history.end(), _linear.begin());
+        std::copy(_history.begin(), (_history.begin() + _historyPosition), (_linear.end() - _historyPosition));
+
+        updateScope();
+        updateSpectrum();
+        return true;
+    }
+
+    // @brief       Function to flatten the views, e.g. once the engine has gone silent
+    // @param       None
+    void AudioAnalyser::clear()
+    {
+        std::fill(_history.begin(), _history.end(), 0.0f);
+        std::fill(_scope.begin(), _scope.end(), 0.0f);
+        std::fill(_spectrum.begin(), _spectrum.end(), minDecibels);
+    }
+
+    // @brief       Function to pick the scope window, starting from the latest rising
+    //              zero crossing that leaves a whole window after it, so a steady
+    //              note stands still
+    // @param       None
+    void AudioAnalyser::updateScope()
+    {
+        int start = fftSize - scopeSize;
+        for (int sample = start; sample > 0; sample--)
+        {
+            if ((0.0f > _linear[static_cast<size_t>(sample - 1)]) && (0.0f <= _linear[static_cast<size_t>(sample)]))
+            {
+                start = sample;
+                break;
+            }
+        }
+
+        std::copy((_linear.begin() + start), (_linear.begin() + start + scopeSize), _scope.begin());
+    }
+
+    // @brief       Function to work out the spectrum of the history in dB
+    // @param       None
+    void AudioAnalyser::updateSpectrum()
+    {
+        std::copy(_linear.begin(), _linear.end(), _fftData.begin());
+        _window.multiplyWithWindowingTable(_fftData.data(), static_cast<size_t>(fftSize));
+        _fft.performFrequencyOnlyForwardTransform(_fftData.data(), true);
+
+        // A full scale sine reads 0dB, the Hann window halves the amplitude
+        const float scale = 4.0f / static_cast<float>(fftSize);
+
+        for (int bin = 0; bin < numBins; bin++)
+        {
+            const float level   = juce::Decibels::gainToDecibels((_fftData[static_cast<size_t>(bin)] * scale), minDecibels);
+            auto& shown         = _spectrum[static_cast<size_t>(bin)];
+
+            // Peaks fall back slowly so they can be read
+            shown = juce::jmax(level, (shown - decayDecibels));
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
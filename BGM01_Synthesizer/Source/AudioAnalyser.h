@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.h
+    Created: 25 Jan 2025 10:21:46am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpscFifo.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Feeds the oscilloscope and spectrum views from the audio callback. The
+    // audio thread only copies its output into a lock-free queue, which is
+    // wait-free and never blocks: whatever doesn't fit is dropped. Everything
+    // else, i.e. keeping the history, triggering the scope and running the FFT,
+    // happens in update on the thread that draws.
+    class AudioAnalyser
+    {
+    public:
+        static constexpr int    fftOrder        = 11;
+        static constexpr int    fftSize         = 1 << fftOrder;
+        static constexpr int    numBins         = fftSize / 2;
+        static constexpr int    scopeSize       = 1024;
+
+        // About a third of a second at 96kHz, far more than a frame's worth
+        static constexpr int    fifoSize        = 32768;
+
+        // Floor of the spectrum, and how far a peak falls per update
+        static constexpr float  minDecibels     = -100.0f;
+        static constexpr float  decayDecibels   = 3.0f;
+
+        AudioAnalyser();
+        ~AudioAnalyser()
+        {
+
+        }
+
+        // Audio thread side
+        void            setSampleRate(double sampleRate)    { _sampleRate.store(sampleRate, std::memory_order_relaxed); }
+        void            push(const float* samples, int numSamples);
+
+        // Drawing thread side
+        bool            update(void);
+        void            clear(void);
+
+        const float*    getScope(void) const                { return _scope.data(); }
+        const float*    getSpectrum(void) const             { return _spectrum.data(); }
+        double          getSampleRate(void) const           { return _sampleRate.load(std::memory_order_relaxed); }
+        juce::int64     getNumDropped(void) const           { return _numDropped.load(std::memory_order_relaxed); }
+
+    private:
+        void            updateScope(void);
+        void            updateSpectrum(void);
+
+        SpscFifo<float>                     _fifo;
+        std::atomic<double>                 _sampleRate;
+        std::atomic<juce::int64>            _numDropped;
+
+        // The last fftSize samples as a ring, and unrolled oldest first
+        std::vector<float>                  _history;
+        std::vector<float>                  _linear;
+        int                                 _historyPosition;
+
+        juce::dsp::FFT                      _fft;
+        juce::dsp::WindowingFunction<float> _window;
+        std::vector<float>                  _fftData;           // 2 * fftSize, as the FFT needs
+
+        std::vector<float>                  _scope;             // scopeSize samples from a rising zero crossing
+        std::vector<float>                  _spectrum;          // numBins levels in dB, with peak decay
+
+        JUCE_DECLARE_NON_COPYABLE(AudioAnalyser)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    CallbackMonitor.cpp
+    Created: 23 Nov 2024 4:02:10pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "CallbackMonitor.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, allocates the queue and history up front
+    CallbackMonitor::CallbackMonitor() :    _records(historySize),
+                                            _historyMs(static_cast<size_t>(historySize)),
+                                            _historyLoad(static_cast<size_t>(historySize)),
+                                            _sortScratch(static_cast<size_t>(historySize))
+    {
+        _ticksPerSample = 0.0;
+        _numOverruns    = 0;
+        _numDropped     = 0;
+        _ticksToMs      = 1000.0 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+        reset();
+    }
+
+    // @brief       Function to set the device rate the deadlines are worked out from
+    // @param       sampleRate = Device sample rate
+    void CallbackMonitor::prepare(double sampleRate)
+    {
+        _ticksPerSample = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / sampleRate;
+    }
+
+    // @brief       Function to record one callback
+    // @param       startTicks = High resolution ticks when the callback started
+    //              endTicks = High resolution ticks when the callback finished
+    //              numSamples = Number of samples the callback produced
+    // @note        Audio thread only, never blocks or allocates
+    void CallbackMonitor::addCallback(juce::int64 startTicks, juce::int64 endTicks, int numSamples)
+    {
+        const Record record = { (endTicks - startTicks),
+                                static_cast<juce::int64>(numSamples * _ticksPerSample.load(std::memory_order_relaxed)) };
+
+        // Overruns are counted here so none are lost when the queue is full
+        if (record.ticks > record.budgetTicks)
+        {
+            _numOverruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (! _records.push(record))
+        {
+            _numDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // @brief       Function to take in the callbacks recorded since the last update
+    // @param       None
+    void CallbackMonitor::update()
+    {
+        Record record;
+        while (_records.pop(record))
+        {
+            const double ms     = record.ticks * _ticksToMs;
+            const double load   = (0 < record.budgetTicks) ? ((100.0 * record.ticks) / record.budgetTicks) : 0.0;
+
+            _historyMs[static_cast<size_t>(_historyPosition)]   = ms;
+            _historyLoad[static_cast<size_t>(_historyPosition)] = load;
+            _historyPosition    = (_historyPosition + 1) % historySize;
+            _historyCount       = juce::jmin((_historyCount + 1), historySize);
+
+            _stats.minMs        = (0 == _stats.numCallbacks) ? ms : juce::jmin(_stats.minMs, ms);
+            _stats.maxMs        = juce::jmax(_stats.maxMs, ms);
+            _stats.maxLoad      = juce::jmax(_stats.maxLoad, load);
+            _stats.budgetMs     = record.budgetTicks * _ticksToMs;
+            _sumMs              += ms;
+            _sumLoad            += load;
+            _stats.numCallbacks++;
+        }
+
+        _stats.numOverruns  = _numOverruns.load(std::memory_order_relaxed);
+        _stats.numDropped   = _numDropped.load(std::memory_order_relaxed);
+
+        if (0 == _stats.numCallbacks)
+        {
+            return;
+        }
+
+        _stats.avgMs    = _sumMs / static_cast<double>(_stats.numCallbacks);
+        _stats.avgLoad  = _sumLoad / static_cast<double>(_stats.numCallbacks);
+
+        // 99th percentile of the recent callbacks
+        auto percentile = [this](const std::vector<double>& history)
+        {
+            auto first  = _sortScratch.begin();
+            auto last   = first + _historyCount;
+            auto nth    = first + ((_historyCount * 99) / 100);
+
+            std::copy(history.begin(), (history.begin() + _historyCount), first);
+            std::nth_element(first, nth, last);
+            return *nth;
+        };
+
+        _stats.p99Ms    = percentile(_historyMs);
+        _stats.p99Load  = percentile(_historyLoad);
+    }
+
+    // @brief       Function to clear the statistics
+    // @param       None
+    void CallbackMonitor::reset()
+    {
+        // Throw away anything still queued from before the reset
+        Record record;
+        while (_records.pop(record))
+        {
+
+        }
+
+        _numOverruns        = 0;
+        _numDropped         = 0;
+        _historyPosition    = 0;
+        _historyCount       = 0;
+        _sumMs              = 0.0;
+        _sumLoad            = 0.0;
+        _stats              = Stats();
+    }
+
+    // @brief       Function to write the statistics and the recent callback times to a file
+    // @param       file = The file to write, replaced if it exists
+    juce::Result CallbackMonitor::writeReport(const juce::File& file) const
+    {
+        juce::String report;
+
+        report << "# BGM01 audio callback timing, " << juce::Time::getCurrentTime().toString(true, true) << "\n"
+               << "# callbacks " << _stats.numCallbacks << ", overruns " << _stats.numOverruns
+               << ", dropped " << _stats.numDropped << "\n"
+               << "# budget " << juce::String(_stats.budgetMs, 3) << " ms\n"
+               << "# time ms min " << juce::String(_stats.minMs, 3) << ", avg " << juce::String(_stats.avgMs, 3)
+               << ", p99 " << juce::String(_stats.p99Ms, 3) << ", max " << juce::String(_stats.maxMs, 3) << "\n"
+               << "# load % avg " << juce::String(_stats.avgLoad, 1) << ", p99 " << juce::String(_stats.p99Load, 1)
+               << ", max " << juce::String(_stats.maxLoad, 1) << "\n"
+               << "callback,time_ms,load_percent\n";
+
+        // Oldest first
+        const int first = (historySize == _historyCount) ? _historyPosition : 0;
+        for (int callback = 0; callback < _historyCount; callback++)
+        {
+            const auto index = static_cast<size_t>((first + callback) % historySize);
+            report << callback << "," << juce::String(_historyMs[index], 4) << "," << juce::String(_historyLoad[index], 2) << "\n";
+        }
+
+        if (! file.replaceWithText(report))
+        {
+            return juce::Result::fail("Could not write " + file.getFullPathName());
+        }
+
+        return juce::Result::ok();
+    }
+}
+//==============================================================================
\ No newline at end of file
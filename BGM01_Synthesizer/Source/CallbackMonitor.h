@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    CallbackMonitor.h
+    Created: 23 Nov 2024 4:02:10pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpscFifo.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Measures how long each audio callback takes against its deadline. The
+    // audio thread only takes two timestamps and pushes them into a lock-free
+    // queue; the message thread drains the queue and works out the statistics.
+    class CallbackMonitor
+    {
+    public:
+        // Number of recent callbacks the percentiles are taken over
+        static constexpr int historySize = 4096;
+
+        // All times are in milliseconds, loads are the percentage of the deadline used
+        struct Stats
+        {
+            double          minMs           = 0.0;
+            double          avgMs           = 0.0;
+            double          p99Ms           = 0.0;
+            double          maxMs           = 0.0;
+            double          budgetMs        = 0.0;
+            double          avgLoad         = 0.0;
+            double          p99Load         = 0.0;
+            double          maxLoad         = 0.0;
+            juce::int64     numCallbacks    = 0;
+            juce::int64     numOverruns     = 0;
+            juce::int64     numDropped      = 0;    // Callbacks the queue had no room for
+        };
+
+        // Times the callback it is created in
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(CallbackMonitor& monitor, int numSamples) : _monitor(monitor),
+                                                                    _numSamples(numSamples),
+                                                                    _start(juce::Time::getHighResolutionTicks())
+            {
+
+            }
+            ~ScopedTimer()
+            {
+                _monitor.addCallback(_start, juce::Time::getHighResolutionTicks(), _numSamples);
+            }
+
+        private:
+            CallbackMonitor&    _monitor;
+            int                 _numSamples;
+            juce::int64         _start;
+
+            JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+        };
+
+        CallbackMonitor();
+        ~CallbackMonitor()
+        {
+
+        }
+
+        // Audio thread side
+        void            prepare(double sampleRate);
+        void            addCallback(juce::int64 startTicks, juce::int64 endTicks, int numSamples);
+
+        // Message thread side
+        void            update(void);
+        void            reset(void);
+        const Stats&    getStats(void) const        { return _stats; }
+        juce::Result    writeReport(const juce::File& file) const;
+
+    private:
+        struct Record
+        {
+            juce::int64     ticks;
+            juce::int64     budgetTicks;        // Time the block lasts for at the device rate
+        };
+
+        SpscFifo<Record>            _records;
+        std::atomic<double>         _ticksPerSample;
+        std::atomic<juce::int64>    _numOverruns;
+        std::atomic<juce::int64>    _numDropped;
+
+        // Message thread, the last historySize callbacks as a ring
+        std::vector<double>         _historyMs;
+        std::vector<double>         _historyLoad;
+        std::vector<double>         _sortScratch;
+        int                         _historyPosition;
+        int                         _historyCount;
+
+        double                      _ticksToMs;
+        double                      _sumMs;
+        double                      _sumLoad;
+        Stats                       _stats;
+
+        JUCE_DECLARE_NON_COPYABLE(CallbackMonitor)
+    };
+}
+//==============================================================================
\ No newline at end of file
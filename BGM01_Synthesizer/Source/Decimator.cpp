@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    Decimator.cpp
+    Created: 3 Feb 2025 9:41:17am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "Decimator.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Transition band, as a fraction of the higher rate, and stopband attenuation
+    // in dB per stage. The last stage down to the base rate is the sharpest,
+    // the ones before it only have to keep images out of that stage's passband.
+    static constexpr double stageTransition[Decimator::maxOrder]    = { 0.06, 0.12, 0.12 };
+    static constexpr double stageAttenuation[Decimator::maxOrder]   = { 70.0, 80.0, 90.0 };
+
+    // @brief       Constructor, designs every stage up front
+    Decimator::Decimator()
+    {
+        _order = 0;
+
+        for (int index = 0; index < maxOrder; index++)
+        {
+            double coefficients[maxCoefficients];
+            auto& stage             = _stages[index];
+            stage.numCoefficients   = designCoefficients(coefficients, stageAttenuation[index], stageTransition[index]);
+
+            for (int coefficient = 0; coefficient < stage.numCoefficients; coefficient++)
+            {
+                stage.coefficients[coefficient] = static_cast<float>(coefficients[coefficient]);
+            }
+        }
+    }
+
+    // @brief       Function to set how many 2x stages run
+    // @param       order = Number of stages, the input rate is 2^order times the output rate
+    void Decimator::setOrder(int order)
+    {
+        _order = juce::jlimit(0, maxOrder, order);
+        reset();
+    }
+
+    // @brief       Function to clear the filter history
+    // @param       None
+    void Decimator::reset()
+    {
+        for (auto& stage : _stages)
+        {
+            for (int channel = 0; channel < maxChannels; channel++)
+            {
+                std::fill(std::begin(stage.x[channel]), std::end(stage.x[channel]), 0.0f);
+                std::fill(std::begin(stage.y[channel]), std::end(stage.y[channel]), 0.0f);
+            }
+        }
+    }
+
+    // @brief       Function to bring a block down to the base rate
+    // @param       input = Oversampled block, 2^order times as long as the output.
+    //                      Used as the work buffer, so its contents are lost.
+    //              output = Block to write to
+    void Decimator::process(const juce::dsp::AudioBlock<float>& input, juce::dsp::AudioBlock<float>& output)
+    {
+        const int numChannels   = juce::jmin(maxChannels, static_cast<int>(input.getNumChannels()), static_cast<int>(output.getNumChannels()));
+        const int numOutput     = static_cast<int>(output.getNumSamples());
+        jassert(static_cast<int>(input.getNumSamples()) >= (numOutput << _order));
+
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            float* data = input.getChannelPointer(static_cast<size_t>(channel));
+            float* out  = output.getChannelPointer(static_cast<size_t>(channel));
+
+            if (0 == _order)
+            {
+                juce::FloatVectorOperations::copy(out, data, numOutput);
+                continue;
+            }
+
+            // Halve in place from the highest rate down, the last stage writes the output
+            for (int index = (_order - 1); index >= 0; index--)
+            {
+                decimate(_stages[index], channel, data, ((0 == index) ? out : data), (numOutput << index));
+            }
+        }
+    }
+
+    // @brief       Function to run one 2x stage
+    // @param       stage = The stage
+    //              channel = Channel, for the filter history
+    //              in = 2 * numSamples input samples
+    //              out = numSamples output samples, can be the input
+    //              numSamples = Number of output samples
+    void Decimator::decimate(Stage& stage, int channel, const float* in, float* out, int numSamples)
+    {
+        const int numCoefficients   = stage.numCoefficients;
+        const float* coefficients   = stage.coefficients;
+        float* x                    = stage.x[channel];
+        float* y                    = stage.y[channel];
+
+        for (int sample = 0; sample < numSamples; sample++)
+        {
+            // The odd sample goes down the first chain and the even one down the
+            // second, each coefficient is an allpass (c + z^-1) / (1 + c z^-1)
+            float paths[2] = { in[(2 * sample) + 1], in[2 * sample] };
+
+            for (int coefficient = 0; coefficient < numCoefficients; coefficient++)
+            {
+                float& value        = paths[coefficient & 1];
+                const float result  = ((value - y[coefficient]) * coefficients[coefficient]) + x[coefficient];
+                x[coefficient]      = value;
+                y[coefficient]      = result;
+                value               = result;
+            }
+
+            out[sample] = 0.5f * (paths[0] + paths[1]);
+        }
+    }
+
+    // @brief       Function to design the allpass coefficients of a half band filter
+    // @param       coefficients = Where to write them, room for maxCoefficients
+    //              attenuation = Stopband attenuation in dB
+    //              transition = Transition band as a fraction of the sample rate, below 0.5
+    // @return      Number of coefficients, the fewest that meet the spec
+    int Decimator::designCoefficients(double* coefficients, double attenuation, double transition)
+    {
+        const double pi = juce::MathConstants<double>::pi;
+
+        // Elliptic modulus of the transition and its nome
+        double k            = std::tan((1.0 - (transition * 2.0)) * pi / 4.0);
+        k                   *= k;
+        const double kk     = std::pow((1.0 - (k * k)), 0.25);
+        const double e      = 0.5 * (1.0 - kk) / (1.0 + kk);
+        const double e4     = std::pow(e, 4.0);
+        const double q      = e * (1.0 + (e4 * (2.0 + (e4 * (15.0 + (150.0 * e4))))));
+
+        // Lowest odd filter order that reaches the attenuation
+        const double power  = std::pow(10.0, (-attenuation / 10.0));
+        const double a      = power / (1.0 - power);
+        int order           = static_cast<int>(std::ceil(std::log((a * a) / 16.0) / std::log(q)));
+        order               = juce::jmax(3, (order | 1));
+
+        const int numCoefficients = juce::jmin(maxCoefficients, ((order - 1) / 2));
+        jassert(((order - 1) / 2) <= maxCoefficients);
+
+        for (int index = 0; index < numCoefficients; index++)
+        {
+            const int c = index + 1;
+
+            // Both series converge quickly, q is well below 1
+            double numerator = 0.0;
+            for (int i = 0, sign = 1; i < 16; i++, sign = -sign)
+            {
+                numerator += std::pow(q, (i * (i + 1))) * std::sin(((2 * i) + 1) * c * pi / order) * sign;
+            }
+
+            double denominator = 0.5;
+            for (int i = 1, sign = -1; i < 16; i++, sign = -sign)
+            {
+                denominator += std::pow(q, (i * i)) * std::cos(2 * i * c * pi / order) * sign;
+            }
+
+            const double w      = (numerator * std::pow(q, 0.25)) / denominator;
+            const double w2     = w * w;
+            const double x      = std::sqrt((1.0 - (w2 * k)) * (1.0 - (w2 / k))) / (1.0 + w2);
+            coefficients[index] = (1.0 - x) / (1.0 + x);
+        }
+
+        return numCoefficients;
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    Decimator.h
+    Created: 3 Feb 2025 9:41:17am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Brings oversampled audio back down to the base rate, 2x per stage. Each
+    // stage is a half band low pass made of two chains of first order allpass
+    // filters, one fed the even samples and the other the odd ones, so it runs
+    // at the lower rate and costs one multiply per coefficient per output
+    // sample. The voices are rendered straight at the high rate, so unlike
+    // juce::dsp::Oversampling there is no upsampling pass to pay for.
+    //
+    // The coefficients are worked out once, with the method from Laurent de
+    // Soras' HIIR library, to the same specs the juce::dsp::Oversampling half
+    // band IIR filters use at maximum quality.
+    class Decimator
+    {
+    public:
+        static constexpr int    maxOrder        = 3;
+        static constexpr int    maxChannels     = 2;
+        static constexpr int    maxCoefficients = 12;
+
+        Decimator();
+        ~Decimator()
+        {
+
+        }
+
+        void    setOrder(int order);
+        void    reset(void);
+
+        void    process(const juce::dsp::AudioBlock<float>& input, juce::dsp::AudioBlock<float>& output);
+
+        int     getOrder(void) const        { return _order; }
+
+        static int  designCoefficients(double* coefficients, double attenuation, double transition);
+
+    private:
+        struct Stage
+        {
+            int     numCoefficients = 0;
+            float   coefficients[maxCoefficients] = {};
+
+            // Allpass input and output history, per channel and coefficient
+            float   x[maxChannels][maxCoefficients] = {};
+            float   y[maxChannels][maxCoefficients] = {};
+        };
+
+        static void     decimate(Stage& stage, int channel, const float* in, float* out, int numSamples);
+
+        // Stage 0 brings 2x down to the base rate and needs the sharpest filter
+        Stage   _stages[maxOrder];
+        int     _order;
+
+        JUCE_DECLARE_NON_COPYABLE(Decimator)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    Envelope.cpp
+    Created: 7 Dec 2024 2:54:19pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "Envelope.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // How far past its end level each segment aims. A large overshoot gives the
+    // attack a nearly linear, punchy rise, a small one gives decay and release
+    // a truly exponential shape that still ends in a finite time.
+    static constexpr float attackOvershoot  = 0.3f;
+    static constexpr float decayOvershoot   = 0.0001f;
+
+    // Time taken to follow a change of sustain level while a note is held
+    static constexpr float sustainGlideTime = 0.01f;
+
+    // Time taken to fade out a voice that is being stolen
+    static constexpr float quickReleaseTime = 0.003f;
+
+    // @brief       Constructor, the envelope starts idle
+    Envelope::Envelope()
+    {
+        _stage          = Stage::idle;
+        _level          = 0.0f;
+        _samplesLeft    = 0;
+
+        setShape(makeShape(0.005f, 0.1f, 1.0f, 0.05f, 44100.0));
+    }
+
+    // @brief       Function to set the rate the envelope runs at
+    // @param       sampleRate = The sample rate in Hz
+    void Envelope::setSampleRate(double sampleRate)
+    {
+        setShape(makeShape(_attackTime, _decayTime, _sustainLevel, _releaseTime, sampleRate));
+    }
+
+    // @brief       Function to set the envelope shape
+    // @param       attack = Attack time in seconds
+    //              decay = Decay time in seconds, from full level to the sustain level
+    //              sustain = Sustain level from 0 to 1
+    //              release = Release time in seconds, from full level to silence
+    void Envelope::setParameters(float attack, float decay, float sustain, float release)
+    {
+        setShape(makeShape(attack, decay, sustain, release, _sampleRate));
+    }
+
+    // @brief       Function to take on a shape made by makeShape, which also sets the sample rate
+    // @param       shape = The times and their curves
+    void Envelope::setShape(const Shape& shape)
+    {
+        _attackTime     = shape.attackTime;
+        _decayTime      = shape.decayTime;
+        _sustainLevel   = shape.sustainLevel;
+        _releaseTime    = shape.releaseTime;
+        _sampleRate     = shape.sampleRate;
+        _attackSegment  = shape.attack;
+        _decaySegment   = shape.decay;
+        _releaseSegment = shape.release;
+
+        // Restart the running segment so it follows the new curve from where it is
+        switch (_stage)
+        {
+            case Stage::attack:
+            case Stage::release:
+                enterStage(_stage);
+                break;
+
+            case Stage::decay:
+                enterStage(_stage);
+                if ((0 == _samplesLeft) && (_level != _sustainLevel))
+                {
+                    // The sustain moved above the level, the decay can't get there
+                    glideToSustain();
+                }
+                break;
+
+            case Stage::sustain:
+                if (_level != _sustainLevel)
+                {
+                    glideToSustain();
+                }
+                break;
+
+            case Stage::idle:
+            default:
+                break;
+        }
+    }
+
+    // @brief       Function to work out the segment curves for a set of times
+    // @param       attack = Attack time in seconds
+    //              decay = Decay time in seconds
+    //              sustain = Sustain level from 0 to 1
+    //              release = Release time in seconds
+    //              sampleRate = Rate the envelope will run at
+    // @return      The shape, for setShape
+    Envelope::Shape Envelope::makeShape(float attack, float decay, float sustain, float release, double sampleRate)
+    {
+        Shape shape;
+        shape.attackTime    = juce::jmax(0.0f, attack);
+        shape.decayTime     = juce::jmax(0.0f, decay);
+        shape.sustainLevel  = juce::jlimit(0.0f, 1.0f, sustain);
+        shape.releaseTime   = juce::jmax(0.0f, release);
+        shape.sampleRate    = sampleRate;
+        shape.attack        = makeSegment(0.0f, 1.0f, attackOvershoot, (shape.attackTime * sampleRate));
+        shape.decay         = makeSegment(1.0f, shape.sustainLevel, decayOvershoot, (shape.decayTime * sampleRate));
+        shape.release       = makeSegment(1.0f, 0.0f, decayOvershoot, (shape.releaseTime * sampleRate));
+        return shape;
+    }
+
+    // @brief       Function to work out an exponential segment
+    // @param       start = Level at the start of the segment
+    //              end = Level at the end of the segment
+    //              overshoot = How far past the end level the curve aims
+    //              numSamples = Length of the segment from start to end
+    Envelope::Segment Envelope::makeSegment(float start, float end, float overshoot, double numSamples)
+    {
+        Segment segment;
+        segment.target = (end > start) ? (end + overshoot) : (end - overshoot);
+
+        if ((1.0 > numSamples) || (start == end))
+        {
+            // Too short to render, the segment ends straight away
+            segment.coeff   = 0.0f;
+            segment.base    = segment.target;
+            return segment;
+        }
+
+        // Distance to the target shrinks by coeff every sample, start to end takes numSamples
+        const double ratio  = (segment.target - start) / static_cast<double>(segment.target - end);
+        segment.coeff       = static_cast<float>(std::exp(-std::log(ratio) / numSamples));
+        segment.base        = segment.target * (1.0f - segment.coeff);
+        return segment;
+    }
+
+    // @brief       Function to work out how long the current level takes to reach a goal
+    // @param       segment = The segment being followed
+    //              goal = The level that ends the segment
+    int Envelope::samplesToReach(const Segment& segment, float goal) const
+    {
+        // Outside (0, 1) the level is already at or past the goal
+        const double ratio = (segment.target - goal) / static_cast<double>(segment.target - _level);
+        if ((0.0f >= segment.coeff) || (0.0 >= ratio) || (1.0 <= ratio))
+        {
+            return 0;
+        }
+
+        // Solves target + (level - target) * coeff^n = goal for n
+        const double samples = std::log(ratio) / std::log(static_cast<double>(segment.coeff));
+        return juce::jmax(0, static_cast<int>(std::ceil(samples)));
+    }
+
+    // @brief       Function to move to a stage and work out where it ends
+    // @param       stage = The stage to move to
+    void Envelope::enterStage(Stage stage)
+    {
+        _stage = stage;
+
+        switch (stage)
+        {
+            case Stage::attack:
+                _segment        = _attackSegment;
+                _samplesLeft    = samplesToReach(_segment, 1.0f);
+                break;
+
+            case Stage::decay:
+                _segment        = _decaySegment;
+                _samplesLeft    = samplesToReach(_segment, _sustainLevel);
+                break;
+
+            case Stage::release:
+                _segment        = _releaseSegment;
+                _samplesLeft    = samplesToReach(_segment, 0.0f);
+                break;
+
+            case Stage::sustain:
+                _level          = _sustainLevel;
+                _samplesLeft    = 0;
+                break;
+
+            case Stage::idle:
+            default:
+                _level          = 0.0f;
+                _samplesLeft    = 0;
+                break;
+        }
+    }
+
+    // @brief       Function to move from the current level to a new sustain level
+    //              over sustainGlideTime, as a decay stage so it ends in the sustain
+    // @param       None
+    void Envelope::glideToSustain()
+    {
+        _stage          = Stage::decay;
+        _segment        = makeSegment(_level, _sustainLevel, decayOvershoot, (sustainGlideTime * _sampleRate));
+        _samplesLeft    = samplesToReach(_segment, _sustainLevel);
+    }
+
+    // @brief       Function to start the attack from the current level
+    // @param       None
+    void Envelope::noteOn()
+    {
+        enterStage(Stage::attack);
+    }
+
+    // @brief       Function to start the release from the current level
+    // @param       None
+    void Envelope::noteOff()
+    {
+        if (Stage::idle != _stage)
+        {
+            enterStage(Stage::release);
+        }
+    }
+
+    // @brief       Function to fade out from the current level over quickReleaseTime,
+    //              whatever the release time, e.g. for a voice that is being stolen
+    // @param       None
+    void Envelope::quickRelease()
+    {
+        if (Stage::idle != _stage)
+        {
+            _stage          = Stage::release;
+            // Nearly linear, an exponential this short would start with a step
+            _segment        = makeSegment(_level, 0.0f, attackOvershoot, (quickReleaseTime * _sampleRate));
+            _samplesLeft    = samplesToReach(_segment, 0.0f);
+        }
+    }
+
+    // @brief       Function to stop the envelope immediately
+    // @param       None
+    void Envelope::reset()
+    {
+        enterStage(Stage::idle);
+    }
+
+    // @brief       Function to apply the envelope to a block in place
+    // @param       left = Samples to multiply by the envelope
+    //              right = Second channel to multiply by the same envelope, or nullptr
+    //              numSamples = Number of samples to process
+    void Envelope::process(float* left, float* right, int numSamples)
+    {
+        int sample = 0;
+        while (sample < numSamples)
+        {
+            if (Stage::idle == _stage)
+            {
+                juce::FloatVectorOperations::clear((left + sample), (numSamples - sample));
+                if (nullptr != right)
+                {
+                    juce::FloatVectorOperations::clear((right + sample), (numSamples - sample));
+                }
+                return;
+            }
+
+            if (Stage::sustain == _stage)
+            {
+                juce::FloatVectorOperations::multiply((left + sample), _sustainLevel, (numSamples - sample));
+                if (nullptr != right)
+                {
+                    juce::FloatVectorOperations::multiply((right + sample), _sustainLevel, (numSamples - sample));
+                }
+                return;
+            }
+
+            const int count         = juce::jmin(_samplesLeft, (numSamples - sample));
+            const float coeff       = _segment.coeff;
+            const float base        = _segment.base;
+
+            float level = _level;
+            if (nullptr == right)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    level               = (level * coeff) + base;
+                    left[sample + i]    *= level;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    level               = (level * coeff) + base;
+                    left[sample + i]    *= level;
+                    right[sample + i]   *= level;
+                }
+            }
+            _level = level;
+
+            sample          += count;
+            _samplesLeft    -= count;
+
+            if (0 >= _samplesLeft)
+            {
+                // Land exactly on the end level, then move on
+                switch (_stage)
+                {
+                    case Stage::attack:
+                        _level = 1.0f;
+                        enterStage(Stage::decay);
+                        break;
+
+                    case Stage::decay:
+                        // Nothing left to hear while the key is held
+                        enterStage((0.0f < _sustainLevel) ? Stage::sustain : Stage::idle);
+                        break;
+
+                    case Stage::release:
+                    default:
+                        enterStage(Stage::idle);
+                        break;
+                }
+            }
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    Envelope.h
+    Created: 7 Dec 2024 2:54:19pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // ADSR envelope with exponential segments. Each segment heads for a target
+    // just past its end level, level = (level * coeff) + base, so a sample costs
+    // one multiply and one add. The length of a segment is worked out when it
+    // starts, so the block loop has no per sample checks. Once the release is
+    // over, or the decay ends at zero sustain, the envelope goes idle and the
+    // voice using it can be skipped.
+    class Envelope
+    {
+    public:
+        enum class Stage
+        {
+            idle,
+            attack,
+            decay,
+            sustain,
+            release
+        };
+
+        Envelope();
+        ~Envelope()
+        {
+
+        }
+
+        // One exponential segment, level = (level * coeff) + base
+        struct Segment
+        {
+            float   coeff   = 0.0f;
+            float   base    = 0.0f;
+            float   target  = 0.0f;     // Where the curve is heading, past the end level
+        };
+
+        // Times and curves for one sample rate. Working out the curves takes a few
+        // logs and exps, so a shape can be made once, off the audio thread, and
+        // handed to every voice's envelope.
+        struct Shape
+        {
+            float   attackTime      = 0.0f;
+            float   decayTime       = 0.0f;
+            float   sustainLevel    = 1.0f;
+            float   releaseTime     = 0.0f;
+            double  sampleRate      = 44100.0;
+            Segment attack;
+            Segment decay;
+            Segment release;
+        };
+
+        void    setSampleRate(double sampleRate);
+        void    setParameters(float attack, float decay, float sustain, float release);
+        void    setShape(const Shape& shape);
+
+        static Shape    makeShape(float attack, float decay, float sustain, float release, double sampleRate);
+
+        void    noteOn(void);
+        void    noteOff(void);
+        void    quickRelease(void);
+        void    reset(void);
+
+        void    process(float* data, int numSamples)    { process(data, nullptr, numSamples); }
+        void    process(float* left, float* right, int numSamples);
+
+        bool    isActive(void) const        { return (Stage::idle != _stage); }
+        Stage   getStage(void) const        { return _stage; }
+        float   getLevel(void) const        { return _level; }
+
+    private:
+        void    enterStage(Stage stage);
+        int     samplesToReach(const Segment& segment, float goal) const;
+        void    glideToSustain(void);
+
+        static Segment  makeSegment(float start, float end, float overshoot, double numSamples);
+
+        Segment _attackSegment;
+        Segment _decaySegment;
+        Segment _releaseSegment;
+        Segment _segment;           // The one being followed, a copy of one of the above or a glide
+
+        Stage   _stage;
+        float   _level;
+        int     _samplesLeft;       // Samples until the current segment ends
+
+        float   _attackTime;
+        float   _decayTime;
+        float   _sustainLevel;
+        float   _releaseTime;
+        double  _sampleRate;
+    };
+}
+//==============================================================================
\ No newline at end of file
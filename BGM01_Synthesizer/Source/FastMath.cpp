@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    FastMath.cpp
+    Created: 18 Jan 2025 9:48:21am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "FastMath.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    namespace FastMath
+    {
+        // @brief       Function to work out the note table, in double precision
+        // @param       None
+        static std::array<float, numNotes> makeNoteFrequencies()
+        {
+            std::array<float, numNotes> table;
+            for (int note = 0; note < numNotes; note++)
+            {
+                table[static_cast<size_t>(note)] = static_cast<float>(440.0 * std::pow(2.0, ((note - 69) / 12.0)));
+            }
+            return table;
+        }
+
+        // @brief       Function to work out the cent table, in double precision
+        // @param       None
+        static std::array<float, centsPerSemitone + 1> makeCentRatios()
+        {
+            std::array<float, centsPerSemitone + 1> table;
+            for (int cent = 0; cent <= centsPerSemitone; cent++)
+            {
+                table[static_cast<size_t>(cent)] = static_cast<float>(std::pow(2.0, (cent / 1200.0)));
+            }
+            return table;
+        }
+
+        const std::array<float, numNotes>               noteFrequencies     = makeNoteFrequencies();
+        const std::array<float, centsPerSemitone + 1>   centRatios          = makeCentRatios();
+
+        // @brief       Function to raise 2 to every value in a buffer
+        // @param       input = Exponents
+        //              output = Results, may be the same buffer as the input
+        //              numValues = Number of values
+        void exp2(const float* input, float* output, int numValues)
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[i] = exp2(input[i]);
+            }
+        }
+
+        // @brief       Function to take the sine of every value in a buffer
+        // @param       input = Angles in radians
+        //              output = Results, may be the same buffer as the input
+        //              numValues = Number of values
+        void sin(const float* input, float* output, int numValues)
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[i] = sin(input[i]);
+            }
+        }
+
+        // @brief       Function to take the tangent of every value in a buffer
+        // @param       input = Angles in radians, within (-pi/2, pi/2)
+        //              output = Results, may be the same buffer as the input
+        //              numValues = Number of values
+        void tan(const float* input, float* output, int numValues)
+        {
+            for (int i = 0; i < numValues; i++)
+            {
+                output[i] = tan(input[i]);
+            }
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Created: 18 Jan 2025 9:48:21am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Cheap replacements for the libm calls that pitch and filter modulation
+    // make, plus tables for turning notes into frequencies. The approximations
+    // are branch free with no lookups, so the block versions vectorise, and
+    // their worst case errors are checked by BGM01_Render --math:
+    //      exp2            relative error below 2e-7 over the normal float range
+    //      sin             absolute error below 1e-6 for angles within a cycle of 0,
+    //                      further out the float angle itself is the limit
+    //      tan             relative error below 1e-6 on (-pi/2, pi/2)
+    //      note tables     relative error below 1e-6, i.e. far under a cent
+    namespace FastMath
+    {
+        static constexpr int    numNotes            = 128;
+        static constexpr int    centsPerSemitone    = 100;
+
+        // Frequency of every MIDI note at A4 = 440Hz, and the ratio for every
+        // whole cent within a semitone, centRatios[100] being exactly 2^(1/12).
+        // Filled in when the program starts.
+        extern const std::array<float, numNotes>                noteFrequencies;
+        extern const std::array<float, centsPerSemitone + 1>    centRatios;
+
+        // Adding and then taking away 1.5 * 2^23 rounds a float to the nearest
+        // integer, and leaves that integer in the low bits of the sum. Only works
+        // without fast math, which would fold the two away.
+        static constexpr float  roundingBias        = 12582912.0f;
+
+        // @brief       Function to bit cast a float to an integer
+        // @param       value = The float
+        inline juce::int32 toBits(float value)
+        {
+            juce::int32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        // @brief       Function to bit cast an integer to a float
+        // @param       bits = IEEE 754 bit pattern
+        inline float fromBits(juce::int32 bits)
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // @brief       Function to raise 2 to a power
+        // @param       x = Exponent, within +/-4 million
+        // @return      2^x, held at the ends of the normal float range
+        inline float exp2(float x)
+        {
+            // Exponent bits from the nearest integer, minimax polynomial for the rest
+            const float shifted = x + roundingBias;
+            const float f       = x - (shifted - roundingBias);
+            const float p       = 1.0f + f * (0.693146978f + f * (0.240222421f + f * (0.0555073379f
+                                       + f * (0.00967151354f + f * 0.00132647142f))));
+
+            // Limited as an integer, a float comparison would stop the block version vectorising
+            juce::int32 whole   = toBits(shifted) - toBits(roundingBias);
+            whole               = (whole < 127) ? whole : 127;
+            whole               = (whole > -126) ? whole : -126;
+
+            return p * fromBits((whole + 127) << 23);
+        }
+
+        // @brief       Function to get the sine of a phase given in cycles
+        // @param       cycles = Phase, one cycle is 2 pi radians, within +/-4 million cycles
+        // @return      sin(2 pi cycles)
+        inline float sinCycles(float cycles)
+        {
+            // Down to [-0.5, 0.5], then the magnitude folded onto [0, 0.25] since
+            // sin(2 pi t) is symmetric about a quarter cycle
+            const float t   = cycles - ((cycles + roundingBias) - roundingBias);
+            const float a   = 0.25f - std::abs(std::abs(t) - 0.25f);
+
+            const float a2  = a * a;
+            return std::copysign((a * (6.28318516f + a2 * (-41.341655f + a2 * (81.6010047f + a2 * (-76.549795f + a2 * 39.5367926f))))), t);
+        }
+
+        // @brief       Function to get the sine of an angle
+        // @param       x = Angle in radians
+        inline float sin(float x)
+        {
+            return sinCycles(x * (1.0f / juce::MathConstants<float>::twoPi));
+        }
+
+        // @brief       Function to get the tangent of an angle, e.g. for prewarping
+        //              a filter cutoff
+        // @param       x = Angle in radians, within (-pi/2, pi/2)
+        inline float tan(float x)
+        {
+            // Above pi/4, tan(x) = 1 / tan(pi/2 - x), so the polynomial only covers [0, pi/4].
+            // pi/2 is split in two so pi/2 - x stays accurate right up to the pole.
+            // The halves are picked with integer masks, as float comparisons would
+            // stop the compiler vectorising the block version.
+            const float a           = std::abs(x);
+            const juce::int32 upper = -static_cast<juce::int32>(toBits(a) > toBits(0.785398163f));
+            const float y           = fromBits((toBits((1.57079637f - a) - 4.37113883e-8f) & upper) | (toBits(a) & ~upper));
+
+            const float y2  = y * y;
+            const float p   = y * (0.999999774f + y2 * (0.333359548f + y2 * (0.13284825f + y2 * (0.0571895598f
+                                   + y2 * (0.0125166584f + y2 * 0.0203989083f)))));
+
+            return std::copysign(fromBits((toBits(1.0f / p) & upper) | (toBits(p) & ~upper)), x);
+        }
+
+        // @brief       Function to get the frequency of a MIDI note
+        // @param       note = Note number, 69 is A4
+        inline float noteToFrequency(int note)
+        {
+            return noteFrequencies[static_cast<size_t>(juce::jlimit(0, (numNotes - 1), note))];
+        }
+
+        // @brief       Function to get the frequency of a fractional note, e.g. after pitch bend
+        // @param       note = Note number, limited to 0 to 127
+        inline float pitchToFrequency(float note)
+        {
+            note = juce::jlimit(0.0f, static_cast<float>(numNotes - 1), note);
+
+            // Whole semitones from the note table, then the cents between them interpolated
+            const int semitone  = static_cast<int>(note);
+            const float cents   = (note - static_cast<float>(semitone)) * static_cast<float>(centsPerSemitone);
+            const int cent      = juce::jmin(static_cast<int>(cents), (centsPerSemitone - 1));
+            const float ratio   = centRatios[static_cast<size_t>(cent)]
+                                + ((cents - static_cast<float>(cent)) * (centRatios[static_cast<size_t>(cent + 1)] - centRatios[static_cast<size_t>(cent)]));
+
+            return noteFrequencies[static_cast<size_t>(semitone)] * ratio;
+        }
+
+        // @brief       Function to turn a pitch offset into a frequency ratio
+        // @param       semitones = Offset, may be fractional or negative
+        inline float semitonesToRatio(float semitones)
+        {
+            return exp2(semitones * (1.0f / 12.0f));
+        }
+
+        // Whole buffers at a time, written so the compiler can vectorise them
+        void    exp2(const float* input, float* output, int numValues);
+        void    sin(const float* input, float* output, int numValues);
+        void    tan(const float* input, float* output, int numValues);
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    Lfo.cpp
+    Created: 11 Jan 2025 2:37:05pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "Lfo.h"
+#include "FastMath.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, a 1Hz sine from the start of its cycle
+    Lfo::Lfo()
+    {
+        _phase      = 0.0f;
+        _rate       = 1.0f;
+        _sampleTime = (1.0f / 44100.0f);
+        _held       = 0.0f;
+        _state      = 1;
+        _shape      = LfoShape::sine;
+    }
+
+    // @brief       Function to set the rate the LFO is stepped at
+    // @param       sampleRate = The sample rate in Hz
+    void Lfo::setSampleRate(double sampleRate)
+    {
+        if (0.0 < sampleRate)
+        {
+            _sampleTime = static_cast<float>(1.0 / sampleRate);
+        }
+    }
+
+    // @brief       Function to set the LFO frequency
+    // @param       hz = Frequency, limited to 0.01Hz to 100Hz
+    void Lfo::setRate(float hz)
+    {
+        _rate = juce::jlimit(0.01f, 100.0f, hz);
+    }
+
+    // @brief       Function to set the LFO waveform
+    // @param       shape = The waveform
+    void Lfo::setShape(LfoShape shape)
+    {
+        _shape = shape;
+    }
+
+    // @brief       Function to restart the random values from a seed
+    // @param       seed = Seed, the same seed gives the same values
+    void Lfo::setSeed(juce::uint32 seed)
+    {
+        _state  = (seed * 0x9e3779b9u) | 1u;
+        _held   = nextRandom();
+    }
+
+    // @brief       Function to restart the LFO from the beginning of its cycle
+    // @param       None
+    void Lfo::reset()
+    {
+        _phase = 0.0f;
+    }
+
+    // @brief       Function to get the LFO value and then move it on
+    // @param       numSamples = Samples until the next call
+    // @return      Value at the current phase, from -1 to 1
+    float Lfo::advance(int numSamples)
+    {
+        float value = 0.0f;
+
+        switch (_shape)
+        {
+            case LfoShape::sine:
+                value = FastMath::sinCycles(_phase);
+                break;
+
+            case LfoShape::triangle:
+            {
+                // Shifted a quarter cycle so it starts at 0 rising, like the sine
+                float shifted = _phase + 0.25f;
+                shifted      -= (1.0f <= shifted) ? 1.0f : 0.0f;
+                value         = 1.0f - (4.0f * std::abs(shifted - 0.5f));
+                break;
+            }
+
+            case LfoShape::saw:
+                value = (2.0f * _phase) - 1.0f;
+                break;
+
+            case LfoShape::square:
+                value = (0.5f > _phase) ? 1.0f : -1.0f;
+                break;
+
+            case LfoShape::random:
+            default:
+                value = _held;
+                break;
+        }
+
+        _phase += _rate * _sampleTime * static_cast<float>(numSamples);
+        if (1.0f <= _phase)
+        {
+            _phase -= std::floor(_phase);
+            _held   = nextRandom();
+        }
+
+        return value;
+    }
+
+    // @brief       Function to get the next random value
+    // @param       None
+    // @return      Value from -1 to 1
+    float Lfo::nextRandom()
+    {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return (static_cast<float>(_state >> 8) * (2.0f / 16777216.0f)) - 1.0f;
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    Lfo.h
+    Created: 11 Jan 2025 2:37:05pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Waveform of a low frequency oscillator
+    enum class LfoShape
+    {
+        sine,
+        triangle,
+        saw,
+        square,
+        random          // Sample and hold, a new value every cycle
+    };
+
+    // Low frequency oscillator for the modulation matrix. It only runs at control
+    // rate, i.e. it is stepped once per control interval rather than per sample,
+    // so the waveform maths can be exact without costing anything noticeable.
+    // Output is from -1 to 1.
+    class Lfo
+    {
+    public:
+        Lfo();
+        ~Lfo()
+        {
+
+        }
+
+        void    setSampleRate(double sampleRate);
+        void    setRate(float hz);
+        void    setShape(LfoShape shape);
+        void    setSeed(juce::uint32 seed);
+        void    reset(void);
+
+        float   advance(int numSamples);
+
+    private:
+        float   nextRandom(void);
+
+        float           _phase;
+        float           _rate;
+        float           _sampleTime;
+        float           _held;          // Current random value
+        juce::uint32    _state;         // Random generator state
+        LfoShape        _shape;
+
+        JUCE_DECLARE_NON_COPYABLE(Lfo)
+    };
+}
+//==============================================================================
\ No newline at end of file
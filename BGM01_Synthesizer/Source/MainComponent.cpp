@@ -1,64 +1,186 @@
 #include "MainComponent.h"
-#include "Synthesizer.h"
+#include "AllocationGuard.h"
 
 //==============================================================================
-MainComponent::MainComponent() :    mainOsc(0.05f, 880.0f), 
-                                    subOsc(0.02f, 220.0f),
-                                    noise(0.01f),
-                                    keys(keysState, juce::MidiKeyboardComponent::horizontalKeyboard)
+MainComponent::MainComponent() :    keys(keysState, juce::MidiKeyboardComponent::horizontalKeyboard)
 {
     addAndMakeVisible(keys);
-    keysState.addListener(this);
 
     // Setup main oscillator volume and label
-    mainOsc_Volume.setRange(0.0f, 0.5f, 0.01f);
-    mainOsc_Volume.setValue(0.05f);
+    mainOsc_Volume.setRange(0.0f, BGM01::Patch::maxLevel, 0.01f);
     mainOsc_Volume.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
-    mainOsc_Volume.onValueChange = [this] { mainOsc.setLevel(mainOsc_Volume.getValue()); };
+    mainOsc_Volume.onValueChange = [this] { engine.setMainLevel(mainOsc_Volume.getValue()); };
     mainOsc_Label.setText("Main Osc.", juce::dontSendNotification);
     mainOsc_Label.attachToComponent(&mainOsc_Volume, false);
     addAndMakeVisible(mainOsc_Volume);
     addAndMakeVisible(mainOsc_Label);
 
     // Setup main oscillator volume and label
-    subOsc_Volume.setRange(0.0f, 0.5f, 0.01f);
-    subOsc_Volume.setValue(0.02f);
+    subOsc_Volume.setRange(0.0f, BGM01::Patch::maxLevel, 0.01f);
     subOsc_Volume.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
-    subOsc_Volume.onValueChange = [this] { subOsc.setLevel(subOsc_Volume.getValue()); };
+    subOsc_Volume.onValueChange = [this] { engine.setSubLevel(subOsc_Volume.getValue()); };
     subOsc_Label.setText("Sub Osc.", juce::dontSendNotification);
     subOsc_Label.attachToComponent(&subOsc_Volume, true);
     addAndMakeVisible(subOsc_Volume);
     addAndMakeVisible(subOsc_Label);
 
     // Setup main oscillator volume and label
-    noiseVolume.setRange(0.0f, 0.5f, 0.01f);
-    noiseVolume.setValue(0.01f);
+    noiseVolume.setRange(0.0f, BGM01::Patch::maxLevel, 0.01f);
     noiseVolume.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
-    noiseVolume.onValueChange = [this] { noise.setLevel(noiseVolume.getValue()); };
+    noiseVolume.onValueChange = [this] { engine.setNoiseLevel(noiseVolume.getValue()); };
     noiseLabel.setText("Noise", juce::dontSendNotification);
     noiseLabel.attachToComponent(&noiseVolume, true);
     addAndMakeVisible(noiseVolume);
     addAndMakeVisible(noiseLabel);
 
+    // Setup noise colour, the ID is the NoiseColour + 1
+    noiseColourBox.addItem("White noise", 1);
+    noiseColourBox.addItem("Pink noise", 2);
+    noiseColourBox.addItem("Brown noise", 3);
+    noiseColourBox.onChange = [this] { engine.setNoiseColour(static_cast<BGM01::NoiseColour>(noiseColourBox.getSelectedId() - 1)); };
+    addAndMakeVisible(noiseColourBox);
+
+    // Setup the main oscillator, the ID is 1 for the saw and table + 2 for the wavetables
+    oscillatorBox.onChange = [this] {
+        const int id = oscillatorBox.getSelectedId();
+        if (1 < id)
+        {
+            engine.setWavetable(id - 2);
+        }
+        engine.setMainOscillator((1 < id) ? BGM01::MainOscillator::wavetable : BGM01::MainOscillator::saw);
+    };
+    addAndMakeVisible(oscillatorBox);
+
     // Setup low pass filter frequency slider
-    filterFreq.setRange(16.0f, 20000.0f, 0.1f);
-    filterFreq.setValue(1000.0f);
+    filterFreq.setRange(BGM01::Patch::minCutoff, BGM01::Patch::maxCutoff, 0.1f);
     filterFreq.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
-    filterFreq.onValueChange = [this] {
-        auto freq = filterFreq.getValue();
-        auto coeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(_sampleRate, freq);
-        *lpFilter.coefficients = coeffs;
-    };
+    filterFreq.onValueChange = [this] { engine.setFilterCutoff(filterFreq.getValue()); };
     filterLabel.setText("Filter", juce::dontSendNotification);
     filterLabel.attachToComponent(&filterFreq, true);
     addAndMakeVisible(filterFreq);
     addAndMakeVisible(filterLabel);
 
+    // Setup the amplitude envelope, times are in seconds
+    setupKnob(attackKnob, attackLabel, "Attack");
+    attackKnob.setRange(0.0, BGM01::Patch::maxEnvelopeTime, 0.001);
+    attackKnob.setSkewFactorFromMidPoint(0.3);
+    attackKnob.onValueChange = [this] { engine.setAttack(static_cast<float>(attackKnob.getValue())); };
+    setupKnob(decayKnob, decayLabel, "Decay");
+    decayKnob.setRange(0.0, BGM01::Patch::maxEnvelopeTime, 0.001);
+    decayKnob.setSkewFactorFromMidPoint(0.3);
+    decayKnob.onValueChange = [this] { engine.setDecay(static_cast<float>(decayKnob.getValue())); };
+    setupKnob(sustainKnob, sustainLabel, "Sustain");
+    sustainKnob.setRange(0.0, 1.0, 0.01);
+    sustainKnob.onValueChange = [this] { engine.setSustain(static_cast<float>(sustainKnob.getValue())); };
+    setupKnob(releaseKnob, releaseLabel, "Release");
+    releaseKnob.setRange(0.0, BGM01::Patch::maxEnvelopeTime, 0.001);
+    releaseKnob.setSkewFactorFromMidPoint(0.3);
+    releaseKnob.onValueChange = [this] { engine.setRelease(static_cast<float>(releaseKnob.getValue())); };
+
+    // Setup unison on the main oscillator, detune is in cents
+    setupKnob(unisonKnob, unisonLabel, "Unison");
+    unisonKnob.setRange(1.0, BGM01::UnisonOscillator::maxOscillators, 1.0);
+    unisonKnob.onValueChange = [this] { engine.setUnisonVoices(static_cast<int>(unisonKnob.getValue())); };
+    setupKnob(detuneKnob, detuneLabel, "Detune");
+    detuneKnob.setRange(0.0, BGM01::Patch::maxDetune, 0.1);
+    detuneKnob.onValueChange = [this] { engine.setUnisonDetune(static_cast<float>(detuneKnob.getValue())); };
+    setupKnob(spreadKnob, spreadLabel, "Spread");
+    spreadKnob.setRange(0.0, 1.0, 0.01);
+    spreadKnob.onValueChange = [this] { engine.setUnisonSpread(static_cast<float>(spreadKnob.getValue())); };
+
+    // Setup the first LFO as vibrato and filter sweep, the depths are matrix amounts
+    setupKnob(lfoRateKnob, lfoRateLabel, "LFO Rate");
+    lfoRateKnob.setRange(BGM01::Patch::minLfoRate, BGM01::Patch::maxLfoRate, 0.01);
+    lfoRateKnob.setSkewFactorFromMidPoint(5.0);
+    lfoRateKnob.onValueChange = [this] { engine.setLfoRate(0, static_cast<float>(lfoRateKnob.getValue())); };
+    setupKnob(vibratoKnob, vibratoLabel, "Vibrato");
+    vibratoKnob.setRange(0.0, 1.0, 0.001);
+    vibratoKnob.setSkewFactorFromMidPoint(0.05);
+    vibratoKnob.onValueChange = [this] {
+        engine.setModulation(0, BGM01::ModSource::lfo1, BGM01::ModDestination::pitch, static_cast<float>(vibratoKnob.getValue()));
+    };
+    setupKnob(lfoFilterKnob, lfoFilterLabel, "LFO Filter");
+    lfoFilterKnob.setRange(0.0, 1.0, 0.01);
+    lfoFilterKnob.onValueChange = [this] {
+        engine.setModulation(1, BGM01::ModSource::lfo1, BGM01::ModDestination::filterCutoff, static_cast<float>(lfoFilterKnob.getValue()));
+    };
+
+    // Setup oversampling factor selection, the ID is the oversampling order + 1
+    oversamplingBox.addItem("Off", 1);
+    oversamplingBox.addItem("2x", 2);
+    oversamplingBox.addItem("4x", 3);
+    oversamplingBox.addItem("8x", 4);
+    oversamplingBox.setSelectedId(1, juce::dontSendNotification);
+    oversamplingBox.onChange = [this] { engine.setOversamplingOrder(oversamplingBox.getSelectedId() - 1); };
+    oversamplingLabel.setText("Oversampling", juce::dontSendNotification);
+    oversamplingLabel.attachToComponent(&oversamplingBox, true);
+    addAndMakeVisible(oversamplingBox);
+    addAndMakeVisible(oversamplingLabel);
 
+    // Setup band limited oscillators, which makes oversampling unnecessary for most patches
+    bandLimitButton.setButtonText("Band-limited");
+    bandLimitButton.onClick = [this] { engine.setBandLimited(bandLimitButton.getToggleState()); };
+    addAndMakeVisible(bandLimitButton);
+
+    // Setup patches, the ones in the patch folder are read now so switching between them is instant
+    loadPatchButton.setButtonText("Load patch");
+    loadPatchButton.onClick = [this] { choosePatchFile(false); };
+    savePatchButton.setButtonText("Save patch");
+    savePatchButton.onClick = [this] { choosePatchFile(true); };
+    patchBox.setTextWhenNothingSelected("Init");
+    patchBox.onChange = [this] { selectPatch(patchBox.getSelectedItemIndex()); };
+    addAndMakeVisible(patchBox);
+    addAndMakeVisible(loadPatchButton);
+    addAndMakeVisible(savePatchButton);
+    scanPatchFolder();
+
+    // Every sound control starts from the engine's default patch
+    updatePatchControls();
+
+    // Setup polyphony, voice stealing and same note retrigger
+    for (int voices = 8; voices <= BGM01::SynthEngine::maxVoices; voices *= 2)
+    {
+        polyphonyBox.addItem(juce::String(voices) + " voices", voices);
+    }
+    polyphonyBox.setSelectedId(16, juce::dontSendNotification);
+    polyphonyBox.onChange = [this] { engine.setPolyphony(polyphonyBox.getSelectedId()); };
+    stealPolicyBox.addItem("Steal oldest", 1);
+    stealPolicyBox.addItem("Steal quietest", 2);
+    stealPolicyBox.setSelectedId(1, juce::dontSendNotification);
+    stealPolicyBox.onChange = [this] {
+        engine.setStealPolicy((2 == stealPolicyBox.getSelectedId()) ? BGM01::SynthEngine::StealPolicy::quietest
+                                                                     : BGM01::SynthEngine::StealPolicy::oldest);
+    };
+    retriggerButton.setButtonText("Retrigger same note");
+    retriggerButton.setToggleState(true, juce::dontSendNotification);
+    retriggerButton.onClick = [this] { engine.setRetriggerSameNote(retriggerButton.getToggleState()); };
+    voicesLabel.setText("Voices", juce::dontSendNotification);
+    voicesLabel.attachToComponent(&polyphonyBox, true);
+    addAndMakeVisible(polyphonyBox);
+    addAndMakeVisible(stealPolicyBox);
+    addAndMakeVisible(retriggerButton);
+    addAndMakeVisible(voicesLabel);
+
+    // Setup the audio callback timing display
+    timingLabel.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+    saveTimingButton.setButtonText("Save timing");
+    saveTimingButton.onClick = [this] { saveTimingReport(); };
+    resetTimingButton.setButtonText("Reset timing");
+    resetTimingButton.onClick = [this] { callbackMonitor.reset(); updateTimingDisplay(); };
+    addAndMakeVisible(timingLabel);
+    addAndMakeVisible(saveTimingButton);
+    addAndMakeVisible(resetTimingButton);
+
+    // Scope and spectrum of the output, drawn from what the audio callback hands over
+    addAndMakeVisible(analyserView);
+
+    // Share the voices between cores when many are playing, leaving some cores
+    // for the device and the GUI. Takes effect when the device is opened below.
+    engine.setNumThreads(juce::jlimit(1, 4, (juce::SystemStats::getNumPhysicalCpus() / 2)));
 
     // Make sure you set the size of the component after
     // you add any child components.
-    setSize(800, 600);
+    setSize(800, 870);
 
     // Some platforms require permissions to open input channels so request that here
     if (juce::RuntimePermissions::isRequired (juce::RuntimePermissions::recordAudio)
@@ -73,15 +195,20 @@ MainComponent::MainComponent() :    mainOsc(0.05f, 880.0f),
         setAudioChannels (0, 2);
     }
 
+    // Notes from MIDI inputs are collected with timestamps and played in the audio callback
+    openMidiInputs();
+
     // Initialize variables
-    _noteOn = false;
+    _keysGrabbed    = false;
 
-    // Wait to grab keyboard
-    startTimer(400);
+    // Grabs the keyboard once it is on screen, then refreshes the timing display
+    startTimerHz(10);
 }
 
 MainComponent::~MainComponent()
 {
+    deviceManager.removeMidiInputDeviceCallback({}, &midiCollector);
+
     // This shuts down the audio device and clears the audio source.
     shutdownAudio();
 }
@@ -89,32 +216,30 @@ MainComponent::~MainComponent()
 //==============================================================================
 void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
-    _sampleTime = static_cast<float>(1.0 / sampleRate);
-    _sampleRate = sampleRate;
-
-    juce::dsp::ProcessSpec specs = { sampleRate, (2 *samplesPerBlockExpected), 2 };
-    lpFilter.prepare(specs);
-    hpFilter.prepare(specs);
-    auto freq = filterFreq.getValue();
-    auto coeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeFirstOrderLowPass(_sampleRate, freq);
-    *lpFilter.coefficients = coeffs;
-    coeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeFirstOrderHighPass(_sampleRate, 100.0f);
-    *hpFilter.coefficients = coeffs;
+    // The engine allocates all its scratch storage here, the audio callback never allocates
+    engine.prepare(sampleRate, samplesPerBlockExpected);
+    callbackMonitor.prepare(sampleRate);
+    analyser.setSampleRate(sampleRate);
+    midiCollector.reset(sampleRate);
+    midiBuffer.ensureSize(4096);
+    collectedMidi.ensureSize(4096);
 }
 
 void MainComponent::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
 {
+    // Time the whole callback against its deadline
+    BGM01::CallbackMonitor::ScopedTimer callbackTimer(callbackMonitor, bufferToFill.numSamples);
+
+    // Flag any heap allocation made on the audio thread (debug builds only)
+    BGM01::ScopedAllocationTrap allocationTrap;
+
     bufferToFill.clearActiveBufferRegion();
-    // Only play notes when a note is on
-    //if (_noteOn)
-    {
-        processSynth(bufferToFill);
-    }
+    processSynth(bufferToFill);
 }
 
 void MainComponent::releaseResources()
 {
-    
+    engine.release();
 }
 
 //==============================================================================
@@ -129,9 +254,11 @@ void MainComponent::resized()
     auto area = getLocalBounds();
 
     constexpr double margin     = 3.0f;
-    constexpr double sliders_h  = 200.0f;
+    constexpr double sliders_h  = 300.0f;
+    constexpr double label_w    = 100.0f;
     constexpr double slider_s   = 50.0f;
     constexpr double keys_h     = 80.0f;
+    constexpr double envelope_h = 110.0f;
 
     auto top_bar = area.removeFromTop(sliders_h);
 
@@ -139,65 +266,243 @@ void MainComponent::resized()
     subOsc_Volume.setBounds(top_bar.removeFromTop(slider_s).reduced(margin));
     noiseVolume.setBounds(top_bar.removeFromTop(slider_s).reduced(margin));
     filterFreq.setBounds(top_bar.removeFromTop(slider_s).reduced(margin));
+    auto options_row = top_bar.removeFromTop(slider_s).reduced(margin).withTrimmedLeft(label_w).withHeight(24);
+    oversamplingBox.setBounds(options_row.removeFromLeft(150));
+    bandLimitButton.setBounds(options_row.removeFromLeft(150).withTrimmedLeft(margin));
+    noiseColourBox.setBounds(options_row.removeFromLeft(150).withTrimmedLeft(margin));
+    oscillatorBox.setBounds(options_row.removeFromLeft(150).withTrimmedLeft(margin));
+    auto voices_row = top_bar.removeFromTop(slider_s).reduced(margin).withTrimmedLeft(label_w).withHeight(24);
+    polyphonyBox.setBounds(voices_row.removeFromLeft(150));
+    stealPolicyBox.setBounds(voices_row.removeFromLeft(150).withTrimmedLeft(margin));
+    retriggerButton.setBounds(voices_row.removeFromLeft(200).withTrimmedLeft(margin));
+    auto envelope_row = area.removeFromTop(envelope_h).reduced(margin).withTrimmedLeft(label_w).withTrimmedTop(20);
+    attackKnob.setBounds(envelope_row.removeFromLeft(90));
+    decayKnob.setBounds(envelope_row.removeFromLeft(90));
+    sustainKnob.setBounds(envelope_row.removeFromLeft(90));
+    releaseKnob.setBounds(envelope_row.removeFromLeft(90));
+    unisonKnob.setBounds(envelope_row.removeFromLeft(90).withTrimmedLeft(margin * 4));
+    detuneKnob.setBounds(envelope_row.removeFromLeft(90));
+    spreadKnob.setBounds(envelope_row.removeFromLeft(90));
+    auto modulation_row = area.removeFromTop(envelope_h).reduced(margin).withTrimmedLeft(label_w).withTrimmedTop(20);
+    lfoRateKnob.setBounds(modulation_row.removeFromLeft(90));
+    vibratoKnob.setBounds(modulation_row.removeFromLeft(90));
+    lfoFilterKnob.setBounds(modulation_row.removeFromLeft(90));
+    auto patch_row = modulation_row.withTrimmedLeft(margin * 4).withSizeKeepingCentre(modulation_row.getWidth() - (margin * 4), 24);
+    patchBox.setBounds(patch_row.removeFromLeft(200));
+    loadPatchButton.setBounds(patch_row.removeFromLeft(100).withTrimmedLeft(margin));
+    savePatchButton.setBounds(patch_row.removeFromLeft(100).withTrimmedLeft(margin));
     keys.setBounds(area.removeFromBottom(keys_h));
+    auto timing_row = area.removeFromBottom(slider_s).reduced(margin).withHeight(24);
+    resetTimingButton.setBounds(timing_row.removeFromRight(110));
+    saveTimingButton.setBounds(timing_row.removeFromRight(110).withTrimmedRight(margin));
+    timingLabel.setBounds(timing_row);
+    analyserView.setBounds(area.reduced(margin));
 }
 
 void MainComponent::timerCallback()
 {
-    keys.grabKeyboardFocus();
-    stopTimer();
+    if ((! _keysGrabbed) && keys.isShowing())
+    {
+        keys.grabKeyboardFocus();
+        _keysGrabbed = true;
+    }
+
+    updateTimingDisplay();
 }
 
-void MainComponent::handleNoteOn(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+void MainComponent::updateTimingDisplay()
 {
-    auto freq = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
-    mainOsc.setFrequency(freq);
-    subOsc.setFrequency(freq / 2.0f);
-    _noteOn = true;
+    callbackMonitor.update();
+    const auto& stats = callbackMonitor.getStats();
+
+    timingLabel.setText("Callback ms min " + juce::String(stats.minMs, 2) + "  avg " + juce::String(stats.avgMs, 2)
+                        + "  p99 " + juce::String(stats.p99Ms, 2) + "  max " + juce::String(stats.maxMs, 2)
+                        + "  |  load avg " + juce::String(stats.avgLoad, 1) + "%  p99 " + juce::String(stats.p99Load, 1)
+                        + "%  |  overruns " + juce::String(stats.numOverruns),
+                        juce::dontSendNotification);
+    timingLabel.setColour(juce::Label::textColourId, (0 < stats.numOverruns) ? juce::Colours::orange : juce::Colours::white);
 }
 
-void MainComponent::handleNoteOff(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+void MainComponent::saveTimingReport()
 {
-    _noteOn = false;
+    auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                    .getNonexistentChildFile("BGM01_CallbackTiming", ".csv");
+    auto result = callbackMonitor.writeReport(file);
+
+    juce::AlertWindow::showMessageBoxAsync(result.wasOk() ? juce::MessageBoxIconType::InfoIcon : juce::MessageBoxIconType::WarningIcon,
+                                           "Callback timing",
+                                           result.wasOk() ? ("Saved to " + file.getFullPathName()) : result.getErrorMessage());
 }
 
-void MainComponent::processSynth(const juce::AudioSourceChannelInfo& outBuffer)
+void MainComponent::updatePatchControls()
 {
-    // NOTE:    Need to use oversampling to get a proper sawtooth sound
-    //          oversampling using naive approach, i.e. buffer twice the 
-    //          size as the original, where every other sample has the
-    //          synth data.
-    
-    juce::AudioBuffer<float> oversample_buf(1, (2 * outBuffer.numSamples));
-    lpFilter.reset();
-
-    auto* data_buf  = oversample_buf.getWritePointer(0, outBuffer.startSample);
-    float time     = 0.0f;
-    for (int sample = 0; sample < outBuffer.numSamples; sample++)
+    // Only shows the patch, the engine already has it
+    const auto& patch = engine.getPatch();
+
+    mainOsc_Volume.setValue(patch.mainLevel, juce::dontSendNotification);
+    subOsc_Volume.setValue(patch.subLevel, juce::dontSendNotification);
+    noiseVolume.setValue(patch.noiseLevel, juce::dontSendNotification);
+    noiseColourBox.setSelectedId((static_cast<int>(patch.noiseColour) + 1), juce::dontSendNotification);
+    updateOscillatorBox();
+    filterFreq.setValue(patch.filterCutoff, juce::dontSendNotification);
+    bandLimitButton.setToggleState(patch.bandLimited, juce::dontSendNotification);
+    attackKnob.setValue(patch.attack, juce::dontSendNotification);
+    decayKnob.setValue(patch.decay, juce::dontSendNotification);
+    sustainKnob.setValue(patch.sustain, juce::dontSendNotification);
+    releaseKnob.setValue(patch.release, juce::dontSendNotification);
+    unisonKnob.setValue(patch.unisonVoices, juce::dontSendNotification);
+    detuneKnob.setValue(patch.unisonDetune, juce::dontSendNotification);
+    spreadKnob.setValue(patch.unisonSpread, juce::dontSendNotification);
+    lfoRateKnob.setValue(patch.lfos[0].rate, juce::dontSendNotification);
+    vibratoKnob.setValue(patch.modulation[0].amount, juce::dontSendNotification);
+    lfoFilterKnob.setValue(patch.modulation[1].amount, juce::dontSendNotification);
+}
+
+void MainComponent::updateOscillatorBox()
+{
+    // The patch may have brought a bank with a different number of tables
+    const auto& patch = engine.getPatch();
+    const char* basic_names[] = { "Sine table", "Triangle table", "Saw table", "Square table" };
+
+    oscillatorBox.clear(juce::dontSendNotification);
+    oscillatorBox.addItem("Saw", 1);
+    for (int table = 0; table < engine.getNumWavetables(); table++)
     {
-        auto sample_data    = mainOsc.sample(time);
-
-        sample_data += subOsc.sample(time);
-        sample_data += noise.sample(time);
-
-        int idx             = (sample << 1);
-        data_buf[idx]       = sample_data;
-        data_buf[idx + 1]   = 0.0f;
-        data_buf[idx]       = lpFilter.processSample(data_buf[idx]);
-        data_buf[idx + 1]   = lpFilter.processSample(data_buf[idx + 1]);
-        data_buf[idx]       = hpFilter.processSample(data_buf[idx]);
-        data_buf[idx + 1]   = hpFilter.processSample(data_buf[idx + 1]);
-        lpFilter.snapToZero();
-        hpFilter.snapToZero();
-        time += _sampleTime;
+        const bool basic = patch.wavetableFile.isEmpty() && (table < BGM01::WavetableBank::numBasicTables);
+        oscillatorBox.addItem(basic ? juce::String(basic_names[table]) : ("Table " + juce::String(table + 1)), (table + 2));
     }
 
-    for (int channel = 0; channel < outBuffer.buffer->getNumChannels(); channel++)
+    const bool wavetable = (BGM01::MainOscillator::wavetable == patch.mainOscillator);
+    oscillatorBox.setSelectedId((wavetable ? (patch.wavetable + 2) : 1), juce::dontSendNotification);
+}
+
+void MainComponent::scanPatchFolder()
+{
+    auto folder = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("BGM01 Patches");
+    auto files  = folder.findChildFiles(juce::File::findFiles, false, juce::String("*") + BGM01::Patch::xmlExtension
+                                                                      + ";*" + BGM01::Patch::binaryExtension);
+    files.sort();
+
+    for (const auto& file : files)
     {
-        auto* out_buf = outBuffer.buffer->getWritePointer(channel, outBuffer.startSample);
-        for (int sample = 0; sample < outBuffer.numSamples; sample++)
+        BGM01::Patch patch;
+        if (patch.loadFromFile(file).wasOk())
         {
-            out_buf[sample] = data_buf[sample << 1];
+            addPatch(patch);
         }
     }
 }
+
+void MainComponent::addPatch(const BGM01::Patch& patch)
+{
+    patches.push_back(patch);
+    patchBox.addItem(patch.name, static_cast<int>(patches.size()));
+}
+
+void MainComponent::selectPatch(int index)
+{
+    if (! juce::isPositiveAndBelow(index, static_cast<int>(patches.size())))
+    {
+        return;
+    }
+
+    // Already parsed, the engine works out the rest and fades over to it
+    auto result = engine.loadPatch(patches[static_cast<size_t>(index)]);
+    updatePatchControls();
+
+    if (result.failed())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Patch", result.getErrorMessage());
+    }
+}
+
+void MainComponent::choosePatchFile(bool save)
+{
+    const juce::String patterns = juce::String("*") + BGM01::Patch::xmlExtension + ";*" + BGM01::Patch::binaryExtension;
+    patchChooser = std::make_unique<juce::FileChooser>(save ? "Save patch" : "Load patch",
+                                                       juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                                           .getChildFile("BGM01 Patches"),
+                                                       patterns);
+
+    const int flags = save ? (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting)
+                           : juce::FileBrowserComponent::openMode;
+
+    patchChooser->launchAsync(flags | juce::FileBrowserComponent::canSelectFiles, [this, save](const juce::FileChooser& chooser)
+    {
+        auto file = chooser.getResult();
+        if (file == juce::File())
+        {
+            return;
+        }
+
+        BGM01::Patch patch = engine.getPatch();
+        juce::Result result = juce::Result::ok();
+
+        if (save)
+        {
+            // XML unless the binary extension was asked for
+            if (! file.hasFileExtension(BGM01::Patch::binaryExtension))
+            {
+                file = file.withFileExtension(BGM01::Patch::xmlExtension);
+            }
+            patch.name  = file.getFileNameWithoutExtension();
+            result      = patch.saveToFile(file);
+        }
+        else
+        {
+            result = patch.loadFromFile(file);
+            if (result.wasOk())
+            {
+                addPatch(patch);
+                patchBox.setSelectedItemIndex((patchBox.getNumItems() - 1));
+            }
+        }
+
+        if (result.failed())
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Patch", result.getErrorMessage());
+        }
+    });
+}
+
+void MainComponent::setupKnob(juce::Slider& knob, juce::Label& label, const juce::String& name)
+{
+    // Rotary with the value underneath and the name on top
+    knob.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    knob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 80, 20);
+    label.setText(name, juce::dontSendNotification);
+    label.setJustificationType(juce::Justification::centred);
+    label.attachToComponent(&knob, false);
+    addAndMakeVisible(knob);
+    addAndMakeVisible(label);
+}
+
+void MainComponent::openMidiInputs()
+{
+    // Listen to every MIDI input, the collector timestamps the events as they arrive.
+    // It needs a rate before the first event, prepareToPlay sets the real one.
+    midiCollector.reset(44100.0);
+    for (auto& input : juce::MidiInput::getAvailableDevices())
+    {
+        deviceManager.setMidiInputDeviceEnabled(input.identifier, true);
+    }
+    deviceManager.addMidiInputDeviceCallback({}, &midiCollector);
+}
+
+void MainComponent::processSynth(const juce::AudioSourceChannelInfo& outBuffer)
+{
+    // Gather the block's events from the MIDI inputs and the on screen keyboard, each
+    // at its sample position, so the engine can start notes mid block. The engine
+    // takes positions from the start of the buffer, the collector's start from 0.
+    midiBuffer.clear();
+    collectedMidi.clear();
+    midiCollector.removeNextBlockOfMessages(collectedMidi, outBuffer.numSamples);
+    midiBuffer.addEvents(collectedMidi, 0, outBuffer.numSamples, outBuffer.startSample);
+    keysState.processNextMidiBuffer(midiBuffer, outBuffer.startSample, outBuffer.numSamples, true);
+
+    // The analyser only gets a copy of the left channel, and nothing while the engine is silent
+    if (engine.renderNextBlock(*outBuffer.buffer, midiBuffer, outBuffer.startSample, outBuffer.numSamples))
+    {
+        analyser.push(outBuffer.buffer->getReadPointer(0, outBuffer.startSample), outBuffer.numSamples);
+    }
+}
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "Synthesizer.h"
+#include "SynthEngine.h"
+#include "CallbackMonitor.h"
+#include "AudioAnalyser.h"
+#include "AnalyserComponent.h"
 
 //==============================================================================
 /*
@@ -9,8 +12,7 @@
     your controls and content.
 */
 class MainComponent  :  public juce::AudioAppComponent,
-                        private juce::Timer,
-                        private juce::MidiKeyboardStateListener
+                        private juce::Timer
 {
 public:
     //==============================================================================
@@ -30,34 +32,80 @@ private:
     //==============================================================================
     // Private member variables...
     void timerCallback() override;
-    void handleNoteOn(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
-    void handleNoteOff(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
+    void openMidiInputs(void);
     void processSynth(const juce::AudioSourceChannelInfo& outBuffer);
+    void updateTimingDisplay(void);
+    void saveTimingReport(void);
+    void setupKnob(juce::Slider& knob, juce::Label& label, const juce::String& name);
+    void updatePatchControls(void);
+    void updateOscillatorBox(void);
+    void scanPatchFolder(void);
+    void addPatch(const BGM01::Patch& patch);
+    void selectPatch(int index);
+    void choosePatchFile(bool save);
 
     // Objects
-    BGM01::SawtoothSynth    mainOsc;
-    BGM01::SquareSynth      subOsc;
-    BGM01::NoiseSynth       noise;
+    BGM01::SynthEngine      engine;
+    BGM01::CallbackMonitor  callbackMonitor;
+    BGM01::AudioAnalyser    analyser;
+    BGM01::AnalyserComponent analyserView { analyser };
 
     juce::MidiKeyboardState     keysState;
+    juce::MidiMessageCollector  midiCollector;
+    juce::MidiBuffer            midiBuffer;
+    juce::MidiBuffer            collectedMidi;
     juce::MidiKeyboardComponent keys;
 
     juce::Slider            mainOsc_Volume;
     juce::Slider            subOsc_Volume;
     juce::Slider            noiseVolume;
     juce::Slider            filterFreq;
+    juce::Slider            attackKnob;
+    juce::Slider            decayKnob;
+    juce::Slider            sustainKnob;
+    juce::Slider            releaseKnob;
+    juce::Slider            unisonKnob;
+    juce::Slider            detuneKnob;
+    juce::Slider            spreadKnob;
+    juce::Slider            lfoRateKnob;
+    juce::Slider            vibratoKnob;
+    juce::Slider            lfoFilterKnob;
+    juce::ComboBox          oversamplingBox;
+    juce::ToggleButton      bandLimitButton;
+    juce::ComboBox          noiseColourBox;
+    juce::ComboBox          oscillatorBox;
+    juce::ComboBox          polyphonyBox;
+    juce::ComboBox          stealPolicyBox;
+    juce::ToggleButton      retriggerButton;
     juce::Label             mainOsc_Label;
     juce::Label             subOsc_Label;
     juce::Label             noiseLabel;
     juce::Label             filterLabel;
+    juce::Label             attackLabel;
+    juce::Label             decayLabel;
+    juce::Label             sustainLabel;
+    juce::Label             releaseLabel;
+    juce::Label             unisonLabel;
+    juce::Label             detuneLabel;
+    juce::Label             spreadLabel;
+    juce::Label             lfoRateLabel;
+    juce::Label             vibratoLabel;
+    juce::Label             lfoFilterLabel;
+    juce::Label             oversamplingLabel;
+    juce::Label             voicesLabel;
+    juce::Label             timingLabel;
+    juce::TextButton        saveTimingButton;
+    juce::TextButton        resetTimingButton;
+    juce::ComboBox          patchBox;
+    juce::TextButton        loadPatchButton;
+    juce::TextButton        savePatchButton;
 
-    juce::dsp::IIR::Filter<float>   lpFilter;
-    juce::dsp::IIR::Filter<float>   hpFilter;
+    // Patches read so far, in the order of patchBox
+    std::vector<BGM01::Patch>           patches;
+    std::unique_ptr<juce::FileChooser>  patchChooser;
     
     // Variables
-    double                  _sampleRate;
-    float                   _sampleTime;
-    bool                    _noteOn;
+    bool                    _keysGrabbed;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Created: 11 Jan 2025 2:37:05pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, every slot starts off
+    ModulationMatrix::ModulationMatrix()
+    {
+        _numActive = 0;
+    }
+
+    // @brief       Function to set up one routing
+    // @param       index = Slot to set, 0 to maxSlots - 1
+    //              source = Where the modulation comes from
+    //              destination = What it changes
+    //              amount = How much, from -1 to 1
+    void ModulationMatrix::setSlot(int index, ModSource source, ModDestination destination, float amount)
+    {
+        if (! juce::isPositiveAndBelow(index, maxSlots))
+        {
+            return;
+        }
+
+        _slots[index].source        = source;
+        _slots[index].destination   = destination;
+        _slots[index].amount        = juce::jlimit(-1.0f, 1.0f, amount);
+        updateActive();
+    }
+
+    // @brief       Function to turn every slot off
+    // @param       None
+    void ModulationMatrix::clear()
+    {
+        _slots.fill(Slot());
+        updateActive();
+    }
+
+    // @brief       Function to work out the modulation of every destination
+    // @param       sources = Current value of each source, indexed by ModSource
+    //              destinations = Sum for each destination, indexed by ModDestination
+    void ModulationMatrix::process(const float* sources, float* destinations) const
+    {
+        for (int destination = 0; destination < numDestinations; destination++)
+        {
+            destinations[destination] = 0.0f;
+        }
+
+        for (int slot = 0; slot < _numActive; slot++)
+        {
+            const auto& active = _active[slot];
+            destinations[static_cast<int>(active.destination)] += sources[static_cast<int>(active.source)] * active.amount;
+        }
+    }
+
+    // @brief       Function to rebuild the list of slots that do something
+    // @param       None
+    void ModulationMatrix::updateActive()
+    {
+        _numActive = 0;
+        for (auto& slot : _slots)
+        {
+            if (0.0f != slot.amount)
+            {
+                _active[_numActive++] = slot;
+            }
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
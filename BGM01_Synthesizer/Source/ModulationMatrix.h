@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 11 Jan 2025 2:37:05pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Where modulation comes from. The LFOs are shared by every voice, the rest
+    // belong to the voice being modulated.
+    enum class ModSource
+    {
+        lfo1,
+        lfo2,
+        envelope,       // Amplitude envelope, 0 to 1
+        velocity,       // Note on velocity, 0 to 1
+        note,           // Note number, -1 to 1 around middle C
+        numSources
+    };
+
+    // What modulation changes. An amount of 1 moves the pitch by pitchRange
+    // semitones, the filter cutoff by cutoffRange octaves, or the voice level
+    // by 100%.
+    enum class ModDestination
+    {
+        pitch,
+        level,
+        filterCutoff,
+        numDestinations
+    };
+
+    // Routing from modulation sources to destinations. Each slot adds its source
+    // times its amount to its destination. The matrix is evaluated once per
+    // voice per control interval, not per sample. It is a plain value, so a
+    // routing can be set up off the audio thread and copied in whole.
+    class ModulationMatrix
+    {
+    public:
+        static constexpr int    maxSlots            = 8;
+        static constexpr int    numSources          = static_cast<int>(ModSource::numSources);
+        static constexpr int    numDestinations     = static_cast<int>(ModDestination::numDestinations);
+        static constexpr float  pitchRange          = 12.0f;
+        static constexpr float  cutoffRange         = 4.0f;
+
+        struct Slot
+        {
+            ModSource       source          = ModSource::lfo1;
+            ModDestination  destination     = ModDestination::pitch;
+            float           amount          = 0.0f;     // -1 to 1, 0 turns the slot off
+        };
+
+        ModulationMatrix();
+        ~ModulationMatrix()
+        {
+
+        }
+
+        void    setSlot(int index, ModSource source, ModDestination destination, float amount);
+        void    clear(void);
+
+        void    process(const float* sources, float* destinations) const;
+
+        const Slot& getSlot(int index) const                { return _slots[index]; }
+        bool        isActive(void) const                    { return (0 < _numActive); }
+
+    private:
+        void    updateActive(void);
+
+        std::array<Slot, maxSlots>  _slots;
+
+        // The slots with a non zero amount, packed to the front so process skips the rest
+        std::array<Slot, maxSlots>  _active;
+        int                         _numActive;
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.cpp
+    Created: 30 Nov 2024 11:26:48am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "NoiseGenerator.h"
+#include <cstring>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Gains that bring the coloured noise back to roughly the RMS level of white noise
+    static constexpr float pinkGain     = 0.34f;
+    static constexpr float brownGain    = 10.0f;
+
+    // The filters below were designed at this rate, and sound the same at any other
+    static constexpr double referenceRate = 44100.0;
+
+    // Paul Kellet's economy pink filter, three leaky integrators, and the brown
+    // noise leak, as pole and input gain at the reference rate
+    static constexpr float pinkPoles[3]     = { 0.99765f, 0.96300f, 0.57000f };
+    static constexpr float pinkInputs[3]    = { 0.0990460f, 0.2965164f, 1.0526913f };
+    static constexpr float brownPole        = 1.0f / 1.02f;
+    static constexpr float brownInput       = 0.02f / 1.02f;
+
+    // @brief       Constructor, starts silent with seed 1
+    NoiseGenerator::NoiseGenerator()
+    {
+        _colour         = NoiseColour::white;
+        _targetLevel    = 0.0f;
+        _currentLevel   = 0.0f;
+
+        setSampleRate(referenceRate);
+        setSeed(1);
+    }
+
+    // @brief       Function to work out the colouring filters for the rate the noise runs at
+    // @param       sampleRate = The sample rate in Hz
+    void NoiseGenerator::setSampleRate(double sampleRate)
+    {
+        // Each pole keeps its corner frequency, p^(ref / rate), and its gain below
+        // the corner, input / (1 - p), so the curves line up in the audible band
+        const double ratio = referenceRate / sampleRate;
+        for (int stage = 0; stage < 3; stage++)
+        {
+            _pinkCoeff[stage] = static_cast<float>(std::pow(static_cast<double>(pinkPoles[stage]), ratio));
+            _pinkInput[stage] = (pinkInputs[stage] / (1.0f - pinkPoles[stage])) * (1.0f - _pinkCoeff[stage]);
+        }
+
+        _brownCoeff = static_cast<float>(std::pow(static_cast<double>(brownPole), ratio));
+        _brownInput = (brownInput / (1.0f - brownPole)) * (1.0f - _brownCoeff);
+
+        // White noise spreads the same power over a wider band at a higher rate
+        _whiteGain  = static_cast<float>(std::sqrt(sampleRate / referenceRate));
+    }
+
+    // @brief       Function to restart the noise from a seed
+    // @param       seed = Any value, each seed gives a different sequence
+    void NoiseGenerator::setSeed(juce::uint32 seed)
+    {
+        // Spread the seed over the lanes with a hash so neighbouring seeds and
+        // lanes don't start out correlated. xorshift can't start from zero.
+        for (int lane = 0; lane < numLanes; lane++)
+        {
+            juce::uint32 hash = seed + (static_cast<juce::uint32>(lane) * 0x9E3779B9u);
+            hash = (hash ^ (hash >> 16)) * 0x85EBCA6Bu;
+            hash = (hash ^ (hash >> 13)) * 0xC2B2AE35u;
+            hash = hash ^ (hash >> 16);
+
+            _state[lane] = (0u != hash) ? hash : 0x6D2B79F5u;
+        }
+
+        _cachePosition  = numLanes;
+        _pink[0]        = 0.0f;
+        _pink[1]        = 0.0f;
+        _pink[2]        = 0.0f;
+        _brown          = 0.0f;
+    }
+
+    // @brief       Function to set the colour of the noise
+    // @param       colour = White, pink or brown
+    void NoiseGenerator::setColour(NoiseColour colour)
+    {
+        _colour = colour;
+    }
+
+    // @brief       Function to set the noise level, the level ramps to it
+    // @param       lvl = The level to set to
+    void NoiseGenerator::setLevel(float lvl)
+    {
+        _targetLevel = lvl;
+    }
+
+    // @brief       Function for rendering noise
+    // @param       out = Buffer the noise is added to
+    //              numSamples = Number of samples to render
+    void NoiseGenerator::renderBlock(float* out, int numSamples)
+    {
+        if ((0.0f >= _targetLevel) && (0.0f >= _currentLevel))
+        {
+            return;
+        }
+
+        switch (_colour)
+        {
+            case NoiseColour::white:    render<NoiseColour::white>(out, numSamples);    break;
+            case NoiseColour::pink:     render<NoiseColour::pink>(out, numSamples);     break;
+            case NoiseColour::brown:    render<NoiseColour::brown>(out, numSamples);    break;
+        }
+    }
+
+    // @brief       Function to step every lane and refill the cache with white noise
+    // @param       None
+    void NoiseGenerator::fillCache()
+    {
+        for (int lane = 0; lane < numLanes; lane++)
+        {
+            juce::uint32 x = _state[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            _state[lane] = x;
+
+            // Top 23 bits as the mantissa of a float in [1, 2), then map to [-1, 1)
+            const juce::uint32 bits = (x >> 9) | 0x3F800000u;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            _cache[lane] = ((value * 2.0f) - 3.0f) * _whiteGain;
+        }
+
+        _cachePosition = 0;
+    }
+
+    // @brief       Function to colour one white noise sample
+    // @param       white = White noise sample
+    template <NoiseColour Colour>
+    float NoiseGenerator::shape(float white)
+    {
+        if (NoiseColour::pink == Colour)
+        {
+            // Paul Kellet's economy pink filter, three leaky integrators
+            _pink[0] = (_pinkCoeff[0] * _pink[0]) + (white * _pinkInput[0]);
+            _pink[1] = (_pinkCoeff[1] * _pink[1]) + (white * _pinkInput[1]);
+            _pink[2] = (_pinkCoeff[2] * _pink[2]) + (white * _pinkInput[2]);
+            return (_pink[0] + _pink[1] + _pink[2] + (white * 0.1848f)) * pinkGain;
+        }
+        else if (NoiseColour::brown == Colour)
+        {
+            // Leaky integrator, the leak stops it wandering off
+            _brown = (_brownCoeff * _brown) + (white * _brownInput);
+            return _brown * brownGain;
+        }
+
+        return white;
+    }
+
+    // @brief       Function for rendering noise of one colour
+    // @param       out = Buffer the noise is added to
+    //              numSamples = Number of samples to render
+    template <NoiseColour Colour>
+    void NoiseGenerator::render(float* out, int numSamples)
+    {
+        int sample = 0;
+        while (sample < numSamples)
+        {
+            if (numLanes <= _cachePosition)
+            {
+                fillCache();
+            }
+
+            const int count     = juce::jmin((numLanes - _cachePosition), (numSamples - sample));
+            const float* white  = _cache + _cachePosition;
+            float* dest         = out + sample;
+
+            if (_currentLevel != _targetLevel)
+            {
+                // Same ramp as the oscillators, up by 0.01 per sample and straight down
+                for (int i = 0; i < count; i++)
+                {
+                    _currentLevel = juce::jmin((_currentLevel + 0.01f), _targetLevel);
+                    dest[i] += _currentLevel * shape<Colour>(white[i]);
+                }
+            }
+            else
+            {
+                const float lvl = _currentLevel;
+                for (int i = 0; i < count; i++)
+                {
+                    dest[i] += lvl * shape<Colour>(white[i]);
+                }
+            }
+
+            _cachePosition  += count;
+            sample          += count;
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
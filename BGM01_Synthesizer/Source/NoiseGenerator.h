@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.h
+    Created: 30 Nov 2024 11:26:48am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Spectral colour of the noise
+    enum class NoiseColour
+    {
+        white,
+        pink,
+        brown
+    };
+
+    // Block based noise source. White noise comes from numLanes independent
+    // xorshift32 generators stepped side by side, which the compiler turns into
+    // SIMD integer code, and the bits are turned into floats without a divide
+    // or branch. The same seed always gives the same noise, whatever the block
+    // sizes, so offline renders are repeatable. The colouring filters are worked
+    // out for the rate the noise runs at, so the spectrum and level in the
+    // audible band stay the same with any sample rate or oversampling.
+    class NoiseGenerator
+    {
+    public:
+        static constexpr int numLanes = 8;
+
+        NoiseGenerator();
+        ~NoiseGenerator()
+        {
+
+        }
+
+        void    setSampleRate(double sampleRate);
+        void    setSeed(juce::uint32 seed);
+        void    setColour(NoiseColour colour);
+        void    setLevel(float lvl);
+
+        void    renderBlock(float* out, int numSamples);
+
+    private:
+        void    fillCache(void);
+
+        template <NoiseColour Colour>
+        void    render(float* out, int numSamples);
+
+        template <NoiseColour Colour>
+        float   shape(float white);
+
+        // Generator state, one xorshift32 per lane
+        alignas(32) juce::uint32    _state[numLanes];
+
+        // White noise generated but not used yet
+        alignas(32) float           _cache[numLanes];
+        int                         _cachePosition;
+
+        // Colouring filter state and coefficients, y = (coeff * y) + (input * x)
+        float                       _pink[3];
+        float                       _brown;
+        float                       _pinkCoeff[3];
+        float                       _pinkInput[3];
+        float                       _brownCoeff;
+        float                       _brownInput;
+        NoiseColour                 _colour;
+
+        // Keeps the white noise at the same level per Hz whatever the rate
+        float                       _whiteGain;
+
+        float                       _targetLevel;
+        float                       _currentLevel;
+    };
+}
+//==============================================================================
\ No newline at end of file
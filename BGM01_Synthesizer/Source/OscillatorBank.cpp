@@ -0,0 +1,371 @@
+/*
+  ==============================================================================
+
+    OscillatorBank.cpp
+    Created: 26 Oct 2024 11:12:40am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "OscillatorBank.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    using namespace PolyBlep;
+    using namespace Kernels;
+
+    // @brief       Constructor, every lane starts silent at 440Hz
+    OscillatorBank::OscillatorBank()
+    {
+        _sampleTime     = (1.0f / 44100.0f);
+        _bandLimited    = true;
+
+        for (int lane = 0; lane < maxLanes; lane++)
+        {
+            _mainPhase[lane]    = 0.0f;
+            _mainLevel[lane]    = 0.0f;
+            _mainTarget[lane]   = 0.0f;
+            _mainFreq[lane]     = 440.0f;
+            _subPhase[lane]     = 0.0f;
+            _subLevel[lane]     = 0.0f;
+            _subTarget[lane]    = 0.0f;
+            _subFreq[lane]      = 220.0f;
+            updateIncrement(lane, false);
+        }
+
+        for (int group = 0; group < maxGroups; group++)
+        {
+            updateKernel(group);
+        }
+    }
+
+    // @brief       Function to set the sample rate all lanes are rendered at
+    // @param       sampleRate = The sample rate in Hz
+    void OscillatorBank::setSampleRate(double sampleRate)
+    {
+        if (0.0 < sampleRate)
+        {
+            _sampleTime = static_cast<float>(1.0 / sampleRate);
+            for (int lane = 0; lane < maxLanes; lane++)
+            {
+                updateIncrement(lane, false);
+            }
+        }
+    }
+
+    // @brief       Function to select the band limited (PolyBLEP) or naive waveforms
+    // @param       bandLimited = True to suppress aliasing at the discontinuities
+    void OscillatorBank::setBandLimited(bool bandLimited)
+    {
+        if (_bandLimited != bandLimited)
+        {
+            _bandLimited = bandLimited;
+            std::fill(std::begin(_dirtyGroups), std::end(_dirtyGroups), true);
+        }
+    }
+
+    // @brief       Function to set the frequencies of a lane
+    // @param       lane = Lane to set
+    //              mainFreq = Main (saw) oscillator frequency
+    //              subFreq = Sub (square) oscillator frequency
+    void OscillatorBank::setFrequency(int lane, float mainFreq, float subFreq)
+    {
+        jassert(juce::isPositiveAndBelow(lane, maxLanes));
+
+        // Make sure frequency is within human hearing range, the same as SynthesizerBase
+        _mainFreq[lane] = juce::jlimit(10.0f, 20000.0f, mainFreq);
+        _subFreq[lane]  = juce::jlimit(10.0f, 20000.0f, subFreq);
+        updateIncrement(lane, false);
+    }
+
+    // @brief       Function to move the frequencies of a lane over the next render,
+    //              the phase increments ramp linearly so the pitch doesn't step
+    // @param       lane = Lane to set
+    //              mainFreq = Main (saw) oscillator frequency
+    //              subFreq = Sub (square) oscillator frequency
+    void OscillatorBank::glideFrequency(int lane, float mainFreq, float subFreq)
+    {
+        jassert(juce::isPositiveAndBelow(lane, maxLanes));
+
+        _mainFreq[lane] = juce::jlimit(10.0f, 20000.0f, mainFreq);
+        _subFreq[lane]  = juce::jlimit(10.0f, 20000.0f, subFreq);
+        updateIncrement(lane, true);
+        _dirtyGroups[lane / groupWidth] = true;
+    }
+
+    // @brief       Function to set the target levels of a lane
+    // @param       lane = Lane to set
+    //              mainLvl = Main oscillator level
+    //              subLvl = Sub oscillator level
+    void OscillatorBank::setLevels(int lane, float mainLvl, float subLvl)
+    {
+        jassert(juce::isPositiveAndBelow(lane, maxLanes));
+        _mainTarget[lane]   = juce::jlimit(0.0f, 1.0f, mainLvl);
+        _subTarget[lane]    = juce::jlimit(0.0f, 1.0f, subLvl);
+        _dirtyGroups[lane / groupWidth] = true;
+    }
+
+    // @brief       Function to get the number of lanes processed per instruction
+    // @param       None
+    int OscillatorBank::getSimdWidth()
+    {
+       #if BGM01_USE_SIMD
+        return static_cast<int>(Vec::SIMDNumElements);
+       #else
+        return 1;
+       #endif
+    }
+
+    // @brief       Function for rendering the active lanes
+    // @param       activeLanes = Bit n set if lane n is to be rendered
+    //              out = Output, lane n is written to out[n * stride]
+    //              stride = Distance between the lane outputs
+    //              numSamples = Number of samples to render, at most stride
+    // @note        The output is overwritten, lanes that are not active are left alone
+    //              unless they share a SIMD register with an active one
+    void OscillatorBank::render(juce::uint64 activeLanes, float* out, int stride, int numSamples)
+    {
+        jassert(numSamples <= stride);
+
+        const juce::uint64 groupMask = ((juce::uint64(1) << groupWidth) - 1);
+
+        for (int group = 0; group < maxGroups; group++)
+        {
+            const int first = group * groupWidth;
+            if (0 == ((activeLanes >> first) & groupMask))
+            {
+                continue;
+            }
+
+            if (_dirtyGroups[group])
+            {
+                updateKernel(group);
+            }
+
+            (this->*_kernels[group])(first, out, stride, numSamples);
+        }
+    }
+
+    // @brief       Function to pick the kernel for a group from its lanes' levels
+    // @param       group = Group to update
+    void OscillatorBank::updateKernel(int group)
+    {
+        bool hasMain    = false;
+        bool hasSub     = false;
+        bool steady     = true;
+
+        for (int lane = group * groupWidth; lane < ((group + 1) * groupWidth); lane++)
+        {
+            // A level that is still above a zero target drops to it on the next sample
+            hasMain    |= (0.0f < _mainTarget[lane]) || (0.0f < _mainLevel[lane]);
+            hasSub     |= (0.0f < _subTarget[lane]) || (0.0f < _subLevel[lane]);
+            steady     &= (_mainLevel[lane] == _mainTarget[lane]) && (_subLevel[lane] == _subTarget[lane])
+                       && (_mainInc[lane] == _mainTargetInc[lane]) && (_subInc[lane] == _subTargetInc[lane]);
+        }
+
+        _kernels[group] = steady ? selectKernel<Steady>(hasMain, hasSub) : selectKernel<Ramped>(hasMain, hasSub);
+        _dirtyGroups[group] = false;
+    }
+
+    // @brief       Function to pick the kernel for the oscillators that are playing
+    // @param       hasMain = True if any lane in the group has the main oscillator on
+    //              hasSub = True if any lane in the group has the sub oscillator on
+    template <typename Level>
+    OscillatorBank::GroupKernel OscillatorBank::selectKernel(bool hasMain, bool hasSub) const
+    {
+        if (hasMain && hasSub)
+        {
+            return selectBandLimit<Saw, Square, Level>();
+        }
+        else if (hasMain)
+        {
+            return selectBandLimit<Saw, Off, Level>();
+        }
+        else if (hasSub)
+        {
+            return selectBandLimit<Off, Square, Level>();
+        }
+
+        return selectBandLimit<Off, Off, Level>();
+    }
+
+    // @brief       Function to pick the naive or band limited version of a kernel
+    // @param       None
+    template <typename MainWave, typename SubWave, typename Level>
+    OscillatorBank::GroupKernel OscillatorBank::selectBandLimit() const
+    {
+        return _bandLimited ? &OscillatorBank::renderGroup<MainWave, SubWave, Level, true>
+                            : &OscillatorBank::renderGroup<MainWave, SubWave, Level, false>;
+    }
+
+    // @brief       Kernel for one group, the SIMD register or a single lane without SIMD
+    // @param       first = First lane of the group
+    //              out = See render
+    //              stride = See render
+    //              numSamples = See render
+    template <typename MainWave, typename SubWave, typename Level, bool BandLimited>
+    void OscillatorBank::renderGroup(int first, float* out, int stride, int numSamples)
+    {
+        float* group_buf = out + (first * stride);
+
+        // Oscillators that are switched off keep running so they stay in phase
+        if constexpr (! MainWave::enabled)
+        {
+            advancePhases(_mainPhase, _mainInc, first, numSamples);
+        }
+        if constexpr (! SubWave::enabled)
+        {
+            advancePhases(_subPhase, _subInc, first, numSamples);
+        }
+
+        if constexpr ((! MainWave::enabled) && (! SubWave::enabled))
+        {
+            // Nothing playing in the whole group
+            for (int lane = 0; lane < groupWidth; lane++)
+            {
+                juce::FloatVectorOperations::clear((group_buf + (lane * stride)), numSamples);
+            }
+        }
+        else
+        {
+           #if BGM01_USE_SIMD
+            using Value = Vec;
+            const auto load = [] (const float* data) { return Vec::fromRawArray(data); };
+            const auto expand = [] (float value) { return Vec::expand(value); };
+            alignas(64) float lanes[groupWidth];
+           #else
+            using Value = float;
+            const auto load = [] (const float* data) { return *data; };
+            const auto expand = [] (float value) { return value; };
+           #endif
+
+            Value mainPhase     = load(_mainPhase + first);
+            Value mainLvl       = load(_mainLevel + first);
+            Value mainInc       = load(_mainInc + first);
+            Value mainInvInc    = load(_mainInvInc + first);
+            const Value mainTarget  = load(_mainTarget + first);
+            Value subPhase      = load(_subPhase + first);
+            Value subLvl        = load(_subLevel + first);
+            Value subInc        = load(_subInc + first);
+            Value subInvInc     = load(_subInvInc + first);
+            const Value subTarget   = load(_subTarget + first);
+
+            // A glide steps the increments evenly to their targets by the last sample.
+            // 1 / inc is stepped evenly too, which is close enough over one render.
+            const Value fraction        = expand(1.0f / static_cast<float>(numSamples));
+            const Value mainIncStep     = (load(_mainTargetInc + first) - mainInc) * fraction;
+            const Value mainInvIncStep  = (load(_mainTargetInvInc + first) - mainInvInc) * fraction;
+            const Value subIncStep      = (load(_subTargetInc + first) - subInc) * fraction;
+            const Value subInvIncStep   = (load(_subTargetInvInc + first) - subInvInc) * fraction;
+
+            for (int sample = 0; sample < numSamples; sample++)
+            {
+                Value value;
+
+                if constexpr (std::is_same<Level, Ramped>::value)
+                {
+                    mainInc     = mainInc + mainIncStep;
+                    mainInvInc  = mainInvInc + mainInvIncStep;
+                    subInc      = subInc + subIncStep;
+                    subInvInc   = subInvInc + subInvIncStep;
+                }
+
+                if constexpr (MainWave::enabled)
+                {
+                    mainLvl     = Level::next(mainLvl, mainTarget);
+                    value       = mainLvl * MainWave::template value<BandLimited>(mainPhase, mainInc, mainInvInc);
+                    mainPhase   = wrap(mainPhase + mainInc);
+                }
+
+                if constexpr (SubWave::enabled)
+                {
+                    subLvl = Level::next(subLvl, subTarget);
+                    const Value sub = subLvl * SubWave::template value<BandLimited>(subPhase, subInc, subInvInc);
+                    subPhase = wrap(subPhase + subInc);
+
+                    if constexpr (MainWave::enabled)
+                    {
+                        value = value + sub;
+                    }
+                    else
+                    {
+                        value = sub;
+                    }
+                }
+
+               #if BGM01_USE_SIMD
+                value.copyToRawArray(lanes);
+
+                // Scatter the lanes out to their voice buffers
+                for (int lane = 0; lane < groupWidth; lane++)
+                {
+                    group_buf[(lane * stride) + sample] = lanes[lane];
+                }
+               #else
+                group_buf[sample] = value;
+               #endif
+            }
+
+           #if BGM01_USE_SIMD
+            mainPhase.copyToRawArray(_mainPhase + first);
+            mainLvl.copyToRawArray(_mainLevel + first);
+            subPhase.copyToRawArray(_subPhase + first);
+            subLvl.copyToRawArray(_subLevel + first);
+           #else
+            _mainPhase[first]   = mainPhase;
+            _mainLevel[first]   = mainLvl;
+            _subPhase[first]    = subPhase;
+            _subLevel[first]    = subLvl;
+           #endif
+        }
+
+        // Once the ramps are done the group can move on to the steady kernel. A glide
+        // always ends on its target, so the increments are set to it exactly.
+        if constexpr (std::is_same<Level, Ramped>::value)
+        {
+            std::copy((_mainTargetInc + first), (_mainTargetInc + first + groupWidth), (_mainInc + first));
+            std::copy((_mainTargetInvInc + first), (_mainTargetInvInc + first + groupWidth), (_mainInvInc + first));
+            std::copy((_subTargetInc + first), (_subTargetInc + first + groupWidth), (_subInc + first));
+            std::copy((_subTargetInvInc + first), (_subTargetInvInc + first + groupWidth), (_subInvInc + first));
+            _dirtyGroups[first / groupWidth] = true;
+        }
+    }
+
+    // @brief       Function to move the phases of a group on without producing output
+    // @param       phase = Main or sub phases
+    //              inc = Matching phase increments
+    //              first = First lane of the group
+    //              numSamples = Number of samples to skip
+    void OscillatorBank::advancePhases(float* phase, const float* inc, int first, int numSamples)
+    {
+        for (int lane = first; lane < (first + groupWidth); lane++)
+        {
+            phase[lane] += inc[lane] * static_cast<float>(numSamples);
+            phase[lane] -= std::floor(phase[lane]);
+        }
+    }
+
+    // @brief       Function to recalculate the phase increments of a lane
+    // @param       lane = Lane to update
+    //              glide = True to ramp to the new increments over the next render,
+    //                      false to jump straight to them
+    void OscillatorBank::updateIncrement(int lane, bool glide)
+    {
+        _mainTargetInc[lane]    = _mainFreq[lane] * _sampleTime;
+        _subTargetInc[lane]     = _subFreq[lane] * _sampleTime;
+        _mainTargetInvInc[lane] = 1.0f / _mainTargetInc[lane];
+        _subTargetInvInc[lane]  = 1.0f / _subTargetInc[lane];
+
+        if (! glide)
+        {
+            _mainInc[lane]      = _mainTargetInc[lane];
+            _subInc[lane]       = _subTargetInc[lane];
+            _mainInvInc[lane]   = _mainTargetInvInc[lane];
+            _subInvInc[lane]    = _subTargetInvInc[lane];
+        }
+    }
+}
+//==============================================================================
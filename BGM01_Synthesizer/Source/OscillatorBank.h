@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    OscillatorBank.h
+    Created: 26 Oct 2024 11:12:40am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscillatorKernels.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Saw (main) and square (sub) oscillators for every voice, stored as a
+    // structure of arrays so one SIMD register holds the same state for 4 or 8
+    // voices. Lane n belongs to voice n.
+    //
+    // Each register of lanes (a group) is rendered by a kernel specialised for
+    // which oscillators are playing, whether the levels or the pitch are still
+    // ramping and the band limiting. The kernel is picked when a lane's levels
+    // or pitch change, e.g. at note on, and once a ramp has finished, not per
+    // sample or per block.
+    class OscillatorBank
+    {
+    public:
+        static constexpr int    maxLanes    = 64;
+
+        OscillatorBank();
+        ~OscillatorBank()
+        {
+
+        }
+
+        void    setSampleRate(double sampleRate);
+        void    setBandLimited(bool bandLimited);
+        void    setFrequency(int lane, float mainFreq, float subFreq);
+        void    glideFrequency(int lane, float mainFreq, float subFreq);
+        void    setLevels(int lane, float mainLvl, float subLvl);
+
+        void    render(juce::uint64 activeLanes, float* out, int stride, int numSamples);
+
+        static int  getSimdWidth(void);
+
+    private:
+       #if BGM01_USE_SIMD
+        static constexpr int    groupWidth  = static_cast<int>(PolyBlep::Vec::SIMDNumElements);
+       #else
+        static constexpr int    groupWidth  = 1;
+       #endif
+        static constexpr int    maxGroups   = maxLanes / groupWidth;
+
+        using GroupKernel = void (OscillatorBank::*)(int first, float* out, int stride, int numSamples);
+
+        template <typename MainWave, typename SubWave, typename Level, bool BandLimited>
+        void        renderGroup(int first, float* out, int stride, int numSamples);
+        template <typename MainWave, typename SubWave, typename Level>
+        GroupKernel selectBandLimit(void) const;
+        template <typename Level>
+        GroupKernel selectKernel(bool hasMain, bool hasSub) const;
+        void        updateKernel(int group);
+        static void advancePhases(float* phase, const float* inc, int first, int numSamples);
+        void        updateIncrement(int lane, bool glide);
+
+        // Per lane oscillator state
+        alignas(64) float   _mainPhase[maxLanes];
+        alignas(64) float   _mainInc[maxLanes];
+        alignas(64) float   _mainInvInc[maxLanes];
+        alignas(64) float   _mainLevel[maxLanes];
+        alignas(64) float   _mainTarget[maxLanes];
+        alignas(64) float   _subPhase[maxLanes];
+        alignas(64) float   _subInc[maxLanes];
+        alignas(64) float   _subInvInc[maxLanes];
+        alignas(64) float   _subLevel[maxLanes];
+        alignas(64) float   _subTarget[maxLanes];
+
+        // Increments a glide is ramping to, the same as the current ones otherwise
+        alignas(64) float   _mainTargetInc[maxLanes];
+        alignas(64) float   _mainTargetInvInc[maxLanes];
+        alignas(64) float   _subTargetInc[maxLanes];
+        alignas(64) float   _subTargetInvInc[maxLanes];
+
+        // Frequencies are kept so the increments can be rebuilt for a new sample rate
+        float               _mainFreq[maxLanes];
+        float               _subFreq[maxLanes];
+
+        // Kernel per group, and a flag per group whose kernel has to be picked again.
+        // The flags are separate so threads rendering different groups don't share a word.
+        GroupKernel         _kernels[maxGroups];
+        bool                _dirtyGroups[maxGroups];
+
+        float               _sampleTime;
+        bool                _bandLimited;
+
+        JUCE_DECLARE_NON_COPYABLE(OscillatorBank)
+    };
+}
+//==============================================================================
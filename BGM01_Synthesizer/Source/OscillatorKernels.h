@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    OscillatorKernels.h
+    Created: 4 Jan 2025 10:12:52am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PolyBlep.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Compile time building blocks for the oscillator kernels. A kernel takes a
+    // waveform policy per oscillator and a level policy as template parameters,
+    // so each combination is its own tight loop with everything inlined and the
+    // oscillators that are switched off compiled out. Every policy works on a
+    // single oscillator (float) and, with SIMD, on a register of them (Vec).
+    namespace Kernels
+    {
+        // Level change per sample while ramping up
+        static constexpr float levelStep = 0.01f;
+
+        // Rising sawtooth, -1 to 1 over the cycle
+        struct Saw
+        {
+            static constexpr bool enabled = true;
+
+            // @brief       Value at a phase, optionally band limited
+            // @param       phase = Phase in [0, 1)
+            //              inc = Phase increment per sample
+            //              invInc = 1 / inc
+            template <bool BandLimited>
+            static inline float value(float phase, float inc, float invInc)
+            {
+                float saw = phase * 2.0f - 1.0f;
+                if constexpr (BandLimited)
+                {
+                    saw -= PolyBlep::blep(phase, inc, invInc);
+                }
+                return saw;
+            }
+
+           #if BGM01_USE_SIMD
+            template <bool BandLimited>
+            static inline PolyBlep::Vec value(PolyBlep::Vec phase, PolyBlep::Vec inc, PolyBlep::Vec invInc)
+            {
+                using Vec = PolyBlep::Vec;
+
+                Vec saw = phase * Vec::expand(2.0f) - Vec::expand(1.0f);
+                if constexpr (BandLimited)
+                {
+                    saw = saw - PolyBlep::blep(phase, inc, invInc);
+                }
+                return saw;
+            }
+           #endif
+        };
+
+        // Square wave, high for the first half of the cycle
+        struct Square
+        {
+            static constexpr bool enabled = true;
+
+            // @brief       Value at a phase, optionally band limited
+            // @param       phase = Phase in [0, 1)
+            //              inc = Phase increment per sample
+            //              invInc = 1 / inc
+            template <bool BandLimited>
+            static inline float value(float phase, float inc, float invInc)
+            {
+                float square = (phase < 0.5f) ? 1.0f : -1.0f;
+                if constexpr (BandLimited)
+                {
+                    // Rising edge at phase 0 and falling edge half a cycle later
+                    const float shifted = PolyBlep::wrap(phase + 0.5f);
+                    square += PolyBlep::blep(phase, inc, invInc) - PolyBlep::blep(shifted, inc, invInc);
+                }
+                return square;
+            }
+
+           #if BGM01_USE_SIMD
+            template <bool BandLimited>
+            static inline PolyBlep::Vec value(PolyBlep::Vec phase, PolyBlep::Vec inc, PolyBlep::Vec invInc)
+            {
+                using Vec = PolyBlep::Vec;
+
+                const Vec half  = Vec::expand(0.5f);
+                Vec square      = Vec::expand(1.0f) - (Vec::expand(2.0f) & Vec::greaterThanOrEqual(phase, half));
+                if constexpr (BandLimited)
+                {
+                    const Vec shifted = PolyBlep::wrap(phase + half);
+                    square = square + PolyBlep::blep(phase, inc, invInc) - PolyBlep::blep(shifted, inc, invInc);
+                }
+                return square;
+            }
+           #endif
+        };
+
+        // An oscillator that is switched off, the kernel leaves it out entirely
+        struct Off
+        {
+            static constexpr bool enabled = false;
+        };
+
+        // Level moving towards its target by levelStep a sample
+        struct Ramped
+        {
+            // @brief       Level for the next sample
+            // @param       lvl = Current level
+            //              target = Level being ramped to
+            static inline float next(float lvl, float target)
+            {
+                return juce::jmin((lvl + levelStep), target);
+            }
+
+           #if BGM01_USE_SIMD
+            static inline PolyBlep::Vec next(PolyBlep::Vec lvl, PolyBlep::Vec target)
+            {
+                return PolyBlep::Vec::min((lvl + PolyBlep::Vec::expand(levelStep)), target);
+            }
+           #endif
+        };
+
+        // Level already at its target, it stays put for the whole block
+        struct Steady
+        {
+            // @brief       Level for the next sample
+            // @param       lvl = Current level
+            template <typename Type>
+            static inline Type next(Type lvl, Type)
+            {
+                return lvl;
+            }
+        };
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,481 @@
+/*
+  ==============================================================================
+
+    Patch.cpp
+    Created: 1 Feb 2025 4:12:08pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "Patch.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Names the enums are written as in XML, in enum order
+    static const std::array<const char*, 3> noiseColourNames    = { "white", "pink", "brown" };
+    static const std::array<const char*, 2> oscillatorNames     = { "saw", "wavetable" };
+    static const std::array<const char*, 5> lfoShapeNames       = { "sine", "triangle", "saw", "square", "random" };
+    static const std::array<const char*, 5> sourceNames         = { "lfo1", "lfo2", "envelope", "velocity", "note" };
+    static const std::array<const char*, 3> destinationNames    = { "pitch", "level", "filterCutoff" };
+
+    static const juce::Identifier patchType         { "Patch" };
+    static const juce::Identifier lfoType           { "LFO" };
+    static const juce::Identifier modulationType    { "Modulation" };
+
+    static const juce::Identifier versionId         { "version" };
+    static const juce::Identifier nameId            { "name" };
+    static const juce::Identifier mainLevelId       { "mainLevel" };
+    static const juce::Identifier subLevelId        { "subLevel" };
+    static const juce::Identifier noiseLevelId      { "noiseLevel" };
+    static const juce::Identifier noiseColourId     { "noiseColour" };
+    static const juce::Identifier bandLimitedId     { "bandLimited" };
+    static const juce::Identifier filterCutoffId    { "filterCutoff" };
+    static const juce::Identifier attackId          { "attack" };
+    static const juce::Identifier decayId           { "decay" };
+    static const juce::Identifier sustainId         { "sustain" };
+    static const juce::Identifier releaseId         { "release" };
+    static const juce::Identifier unisonVoicesId    { "unisonVoices" };
+    static const juce::Identifier unisonDetuneId    { "unisonDetune" };
+    static const juce::Identifier unisonSpreadId    { "unisonSpread" };
+    static const juce::Identifier mainOscillatorId  { "mainOscillator" };
+    static const juce::Identifier wavetableId       { "wavetable" };
+    static const juce::Identifier wavetableFileId   { "wavetableFile" };
+    static const juce::Identifier indexId           { "index" };
+    static const juce::Identifier rateId            { "rate" };
+    static const juce::Identifier shapeId           { "shape" };
+    static const juce::Identifier sourceId          { "source" };
+    static const juce::Identifier destinationId     { "destination" };
+    static const juce::Identifier amountId          { "amount" };
+
+    // Size of the version 1 payload without the name
+    static constexpr int binarySize = (3 * 4) + 4 + 1 + 4 + (4 * 4) + (3 * 4) + (Patch::numLfos * 8) + (ModulationMatrix::maxSlots * 12);
+
+    // @brief       Function to read an enum written as its name
+    // @param       tree = Node holding the property
+    //              id = The property, if it is missing the value is left alone
+    //              names = Names in enum order
+    //              value = Set to the enum
+    // @return      Failed if the name is not one of names
+    template <typename Enum, size_t NumNames>
+    static juce::Result readEnum(const juce::ValueTree& tree, const juce::Identifier& id,
+                                 const std::array<const char*, NumNames>& names, Enum& value)
+    {
+        if (! tree.hasProperty(id))
+        {
+            return juce::Result::ok();
+        }
+
+        const juce::String text = tree[id].toString();
+        for (size_t index = 0; index < NumNames; index++)
+        {
+            if (text == names[index])
+            {
+                value = static_cast<Enum>(index);
+                return juce::Result::ok();
+            }
+        }
+
+        return juce::Result::fail("Unknown " + id.toString() + " \"" + text + "\"");
+    }
+
+    // @brief       Function to read an enum written as its index
+    // @param       stream = Where to read from
+    //              numValues = Number of values the enum has
+    //              value = Set to the enum
+    // @return      False if the index is out of range
+    template <typename Enum>
+    static bool readEnum(juce::InputStream& stream, int numValues, Enum& value)
+    {
+        const int index = stream.readInt();
+        if (! juce::isPositiveAndBelow(index, numValues))
+        {
+            return false;
+        }
+
+        value = static_cast<Enum>(index);
+        return true;
+    }
+
+    // @brief       Function to hold every setting to its range, so a damaged or hand
+    //              edited patch can't put extreme values on the audio thread
+    // @param       None
+    // @return      Failed if a value is not a finite number, the patch is left as it was
+    juce::Result Patch::limitRanges()
+    {
+        bool finite = std::isfinite(mainLevel) && std::isfinite(subLevel) && std::isfinite(noiseLevel)
+                   && std::isfinite(filterCutoff) && std::isfinite(attack) && std::isfinite(decay)
+                   && std::isfinite(sustain) && std::isfinite(release) && std::isfinite(unisonDetune)
+                   && std::isfinite(unisonSpread);
+        for (const auto& lfo : lfos)
+        {
+            finite &= std::isfinite(lfo.rate);
+        }
+        for (const auto& routing : modulation)
+        {
+            finite &= std::isfinite(routing.amount);
+        }
+
+        if (! finite)
+        {
+            return juce::Result::fail("The patch holds a value that is not a number");
+        }
+
+        mainLevel       = juce::jlimit(0.0f, maxLevel, mainLevel);
+        subLevel        = juce::jlimit(0.0f, maxLevel, subLevel);
+        noiseLevel      = juce::jlimit(0.0f, maxLevel, noiseLevel);
+        filterCutoff    = juce::jlimit(minCutoff, maxCutoff, filterCutoff);
+        attack          = juce::jlimit(0.0f, maxEnvelopeTime, attack);
+        decay           = juce::jlimit(0.0f, maxEnvelopeTime, decay);
+        sustain         = juce::jlimit(0.0f, 1.0f, sustain);
+        release         = juce::jlimit(0.0f, maxEnvelopeTime, release);
+        unisonVoices    = juce::jlimit(1, UnisonOscillator::maxOscillators, unisonVoices);
+        unisonDetune    = juce::jlimit(0.0f, maxDetune, unisonDetune);
+        unisonSpread    = juce::jlimit(0.0f, 1.0f, unisonSpread);
+        wavetable       = juce::jmax(0, wavetable);
+
+        for (auto& lfo : lfos)
+        {
+            lfo.rate = juce::jlimit(minLfoRate, maxLfoRate, lfo.rate);
+        }
+        for (auto& routing : modulation)
+        {
+            routing.amount = juce::jlimit(-1.0f, 1.0f, routing.amount);
+        }
+
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to describe the patch as a ValueTree, for XML
+    // @param       None
+    // @return      The tree, only slots that are in use are written
+    juce::ValueTree Patch::toValueTree() const
+    {
+        juce::ValueTree tree(patchType);
+        tree.setProperty(versionId, static_cast<int>(fileVersion), nullptr);
+        tree.setProperty(nameId, name, nullptr);
+        tree.setProperty(mainLevelId, mainLevel, nullptr);
+        tree.setProperty(subLevelId, subLevel, nullptr);
+        tree.setProperty(noiseLevelId, noiseLevel, nullptr);
+        tree.setProperty(noiseColourId, noiseColourNames[static_cast<size_t>(noiseColour)], nullptr);
+        tree.setProperty(bandLimitedId, bandLimited, nullptr);
+        tree.setProperty(filterCutoffId, filterCutoff, nullptr);
+        tree.setProperty(attackId, attack, nullptr);
+        tree.setProperty(decayId, decay, nullptr);
+        tree.setProperty(sustainId, sustain, nullptr);
+        tree.setProperty(releaseId, release, nullptr);
+        tree.setProperty(unisonVoicesId, unisonVoices, nullptr);
+        tree.setProperty(unisonDetuneId, unisonDetune, nullptr);
+        tree.setProperty(unisonSpreadId, unisonSpread, nullptr);
+        tree.setProperty(mainOscillatorId, oscillatorNames[static_cast<size_t>(mainOscillator)], nullptr);
+        tree.setProperty(wavetableId, wavetable, nullptr);
+        tree.setProperty(wavetableFileId, wavetableFile, nullptr);
+
+        for (int lfo = 0; lfo < numLfos; lfo++)
+        {
+            juce::ValueTree child(lfoType);
+            child.setProperty(indexId, lfo, nullptr);
+            child.setProperty(rateId, lfos[static_cast<size_t>(lfo)].rate, nullptr);
+            child.setProperty(shapeId, lfoShapeNames[static_cast<size_t>(lfos[static_cast<size_t>(lfo)].shape)], nullptr);
+            tree.appendChild(child, nullptr);
+        }
+
+        for (int slot = 0; slot < ModulationMatrix::maxSlots; slot++)
+        {
+            const auto& routing = modulation[static_cast<size_t>(slot)];
+            if (0.0f == routing.amount)
+            {
+                continue;
+            }
+
+            juce::ValueTree child(modulationType);
+            child.setProperty(indexId, slot, nullptr);
+            child.setProperty(sourceId, sourceNames[static_cast<size_t>(routing.source)], nullptr);
+            child.setProperty(destinationId, destinationNames[static_cast<size_t>(routing.destination)], nullptr);
+            child.setProperty(amountId, routing.amount, nullptr);
+            tree.appendChild(child, nullptr);
+        }
+
+        return tree;
+    }
+
+    // @brief       Function to set the patch from a ValueTree written by toValueTree
+    // @param       tree = The tree, anything it leaves out gets its default
+    // @return      Failed if the tree is not a patch or holds an unknown name, the
+    //              patch is left as it was
+    juce::Result Patch::fromValueTree(const juce::ValueTree& tree)
+    {
+        if (! tree.hasType(patchType))
+        {
+            return juce::Result::fail("Not a patch");
+        }
+        if (static_cast<int>(fileVersion) < static_cast<int>(tree.getProperty(versionId, 1)))
+        {
+            return juce::Result::fail("The patch is from a newer version");
+        }
+
+        Patch patch;
+        patch.name          = tree.getProperty(nameId, patch.name).toString();
+        patch.mainLevel     = tree.getProperty(mainLevelId, patch.mainLevel);
+        patch.subLevel      = tree.getProperty(subLevelId, patch.subLevel);
+        patch.noiseLevel    = tree.getProperty(noiseLevelId, patch.noiseLevel);
+        patch.bandLimited   = tree.getProperty(bandLimitedId, patch.bandLimited);
+        patch.filterCutoff  = tree.getProperty(filterCutoffId, patch.filterCutoff);
+        patch.attack        = tree.getProperty(attackId, patch.attack);
+        patch.decay         = tree.getProperty(decayId, patch.decay);
+        patch.sustain       = tree.getProperty(sustainId, patch.sustain);
+        patch.release       = tree.getProperty(releaseId, patch.release);
+        patch.unisonVoices  = tree.getProperty(unisonVoicesId, patch.unisonVoices);
+        patch.unisonDetune  = tree.getProperty(unisonDetuneId, patch.unisonDetune);
+        patch.unisonSpread  = tree.getProperty(unisonSpreadId, patch.unisonSpread);
+        patch.wavetable     = tree.getProperty(wavetableId, patch.wavetable);
+        patch.wavetableFile = tree.getProperty(wavetableFileId, patch.wavetableFile).toString();
+
+        auto result = readEnum(tree, noiseColourId, noiseColourNames, patch.noiseColour);
+        if (result.wasOk())
+        {
+            result = readEnum(tree, mainOscillatorId, oscillatorNames, patch.mainOscillator);
+        }
+
+        for (const auto& child : tree)
+        {
+            if (result.failed())
+            {
+                return result;
+            }
+
+            const int index = child.getProperty(indexId, -1);
+
+            if (child.hasType(lfoType) && juce::isPositiveAndBelow(index, numLfos))
+            {
+                auto& lfo   = patch.lfos[static_cast<size_t>(index)];
+                lfo.rate    = child.getProperty(rateId, lfo.rate);
+                result      = readEnum(child, shapeId, lfoShapeNames, lfo.shape);
+            }
+            else if (child.hasType(modulationType) && juce::isPositiveAndBelow(index, ModulationMatrix::maxSlots))
+            {
+                auto& routing   = patch.modulation[static_cast<size_t>(index)];
+                routing.amount  = child.getProperty(amountId, routing.amount);
+                result          = readEnum(child, sourceId, sourceNames, routing.source);
+                if (result.wasOk())
+                {
+                    result = readEnum(child, destinationId, destinationNames, routing.destination);
+                }
+            }
+            else
+            {
+                return juce::Result::fail("Unexpected " + child.getType().toString() + " in the patch");
+            }
+        }
+
+        if (result.wasOk())
+        {
+            result = patch.limitRanges();
+        }
+        if (result.wasOk())
+        {
+            *this = patch;
+        }
+        return result;
+    }
+
+    // @brief       Function to write the patch in the binary form
+    // @param       stream = Where to write, header included
+    void Patch::writeBinary(juce::OutputStream& stream) const
+    {
+        juce::MemoryOutputStream payload(static_cast<size_t>(binarySize + name.getNumBytesAsUTF8() + 8 + wavetableFile.getNumBytesAsUTF8() + 2));
+        payload.writeFloat(mainLevel);
+        payload.writeFloat(subLevel);
+        payload.writeFloat(noiseLevel);
+        payload.writeInt(static_cast<int>(noiseColour));
+        payload.writeBool(bandLimited);
+        payload.writeFloat(filterCutoff);
+        payload.writeFloat(attack);
+        payload.writeFloat(decay);
+        payload.writeFloat(sustain);
+        payload.writeFloat(release);
+        payload.writeInt(unisonVoices);
+        payload.writeFloat(unisonDetune);
+        payload.writeFloat(unisonSpread);
+
+        for (const auto& lfo : lfos)
+        {
+            payload.writeFloat(lfo.rate);
+            payload.writeInt(static_cast<int>(lfo.shape));
+        }
+        for (const auto& routing : modulation)
+        {
+            payload.writeInt(static_cast<int>(routing.source));
+            payload.writeInt(static_cast<int>(routing.destination));
+            payload.writeFloat(routing.amount);
+        }
+        payload.writeString(name);
+        payload.writeInt(static_cast<int>(mainOscillator));
+        payload.writeInt(wavetable);
+        payload.writeString(wavetableFile);
+
+        stream.writeInt(static_cast<int>(fileMagic));
+        stream.writeInt(static_cast<int>(fileVersion));
+        stream.writeInt(static_cast<int>(payload.getDataSize()));
+        stream.write(payload.getData(), payload.getDataSize());
+    }
+
+    // @brief       Function to read a patch written by writeBinary
+    // @param       stream = Where to read from, positioned at the header
+    // @return      Failed if the data is not a patch or is damaged, the patch is
+    //              left as it was
+    juce::Result Patch::readBinary(juce::InputStream& stream)
+    {
+        const auto magic    = static_cast<juce::uint32>(stream.readInt());
+        const auto version  = static_cast<juce::uint32>(stream.readInt());
+        const int size      = stream.readInt();
+
+        if ((fileMagic != magic) || (0 == version) || (fileVersion < version))
+        {
+            return juce::Result::fail("Not a binary patch or from a newer version");
+        }
+
+        const auto remaining = stream.getNumBytesRemaining();
+        if ((binarySize > size) || ((0 <= remaining) && (remaining < size)))
+        {
+            return juce::Result::fail("The binary patch is truncated");
+        }
+
+        // Read as a block, so a damaged size can't run into whatever follows
+        juce::MemoryBlock block;
+        if (size != static_cast<int>(stream.readIntoMemoryBlock(block, size)))
+        {
+            return juce::Result::fail("The binary patch is truncated");
+        }
+
+        juce::MemoryInputStream payload(block, false);
+
+        Patch patch;
+        bool valid = true;
+
+        patch.mainLevel     = payload.readFloat();
+        patch.subLevel      = payload.readFloat();
+        patch.noiseLevel    = payload.readFloat();
+        valid              &= readEnum(payload, static_cast<int>(noiseColourNames.size()), patch.noiseColour);
+        patch.bandLimited   = payload.readBool();
+        patch.filterCutoff  = payload.readFloat();
+        patch.attack        = payload.readFloat();
+        patch.decay         = payload.readFloat();
+        patch.sustain       = payload.readFloat();
+        patch.release       = payload.readFloat();
+        patch.unisonVoices  = payload.readInt();
+        patch.unisonDetune  = payload.readFloat();
+        patch.unisonSpread  = payload.readFloat();
+
+        for (auto& lfo : patch.lfos)
+        {
+            lfo.rate    = payload.readFloat();
+            valid      &= readEnum(payload, static_cast<int>(lfoShapeNames.size()), lfo.shape);
+        }
+        for (auto& routing : patch.modulation)
+        {
+            valid          &= readEnum(payload, ModulationMatrix::numSources, routing.source);
+            valid          &= readEnum(payload, ModulationMatrix::numDestinations, routing.destination);
+            routing.amount  = payload.readFloat();
+        }
+        patch.name          = payload.readString();
+
+        if (2 <= version)
+        {
+            valid              &= readEnum(payload, static_cast<int>(oscillatorNames.size()), patch.mainOscillator);
+            patch.wavetable     = payload.readInt();
+            patch.wavetableFile = payload.readString();
+        }
+
+        if (! valid)
+        {
+            return juce::Result::fail("The binary patch holds an unknown setting");
+        }
+
+        const auto result = patch.limitRanges();
+        if (result.wasOk())
+        {
+            *this = patch;
+        }
+        return result;
+    }
+
+    // @brief       Function to save the patch, binary if the file has the binary
+    //              extension and XML otherwise
+    // @param       file = The file, replaced in one go so a failed save leaves it intact
+    // @return      Failed if the file could not be written
+    juce::Result Patch::saveToFile(const juce::File& file) const
+    {
+        juce::TemporaryFile temp(file);
+
+        {
+            juce::FileOutputStream stream(temp.getFile());
+            if (! stream.openedOk())
+            {
+                return juce::Result::fail("Could not create " + temp.getFile().getFullPathName());
+            }
+
+            if (file.hasFileExtension(binaryExtension))
+            {
+                writeBinary(stream);
+            }
+            else if (auto xml = toValueTree().createXml())
+            {
+                xml->writeTo(stream);
+            }
+
+            stream.flush();
+            if (stream.getStatus().failed())
+            {
+                return stream.getStatus();
+            }
+        }
+
+        if (! temp.overwriteTargetFileWithTemporary())
+        {
+            return juce::Result::fail("Could not replace " + file.getFullPathName());
+        }
+
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to load a patch in either form
+    // @param       file = The file, the form is told from its contents
+    // @return      Failed if the file can't be read or is not a patch, the patch
+    //              is left as it was
+    juce::Result Patch::loadFromFile(const juce::File& file)
+    {
+        juce::MemoryBlock data;
+        if (! file.loadFileAsData(data))
+        {
+            return juce::Result::fail("Could not read " + file.getFullPathName());
+        }
+
+        juce::Result result = juce::Result::ok();
+
+        juce::MemoryInputStream stream(data, false);
+        if ((4 <= data.getSize()) && (fileMagic == static_cast<juce::uint32>(stream.readInt())))
+        {
+            stream.setPosition(0);
+            result = readBinary(stream);
+        }
+        else if (auto xml = juce::parseXML(data.toString()))
+        {
+            result = fromValueTree(juce::ValueTree::fromXml(*xml));
+        }
+        else
+        {
+            result = juce::Result::fail("Not a patch");
+        }
+
+        if (result.failed())
+        {
+            return juce::Result::fail(file.getFullPathName() + ": " + result.getErrorMessage());
+        }
+
+        return juce::Result::ok();
+    }
+}
+//==============================================================================
\ No newline at end of file
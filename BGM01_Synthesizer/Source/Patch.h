@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Patch.h
+    Created: 1 Feb 2025 4:12:08pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+#include "SynthVoice.h"
+#include "Lfo.h"
+#include "ModulationMatrix.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Everything that makes up a sound: main oscillator, oscillator levels,
+    // filter, envelope, unison, LFOs and modulation routing. How the engine runs
+    // (polyphony, oversampling, threads) is not part of a patch.
+    //
+    // Patches are stored in one of two forms, chosen by the file extension:
+    //  - XML (.bgpatch), written from a ValueTree, for editing by hand and
+    //    exchange. Missing settings keep their defaults.
+    //  - Binary (.bgpb), a fixed layout that loads without any parsing.
+    // Loading works out the form from the contents, whatever the extension.
+    //
+    // Binary layout, little endian:
+    //      Header          magic, version, payload size, all uint32
+    //      Levels          float main, sub, noise; int32 noise colour; uint8 band limited
+    //      Filter          float cutoff
+    //      Envelope        float attack, decay, sustain, release
+    //      Unison          int32 voices; float detune, spread
+    //      LFOs            numLfos * (float rate; int32 shape)
+    //      Modulation      ModulationMatrix::maxSlots * (int32 source, destination; float amount)
+    //      Name            UTF-8, zero terminated
+    //      Oscillator      int32 main oscillator, wavetable; wavetable file as UTF-8,
+    //                      zero terminated (version 2)
+    // Later versions only append to the payload, so older files still load.
+    struct Patch
+    {
+        static constexpr juce::uint32   fileMagic           = 0x54504742;   // "BGPT"
+        static constexpr juce::uint32   fileVersion         = 2;
+        static constexpr int            numLfos             = 2;
+
+        static constexpr const char*    xmlExtension        = ".bgpatch";
+        static constexpr const char*    binaryExtension     = ".bgpb";
+
+        // Ranges the settings are held to, the same the synth's controls offer
+        static constexpr float          maxLevel            = 0.5f;
+        static constexpr float          minCutoff           = 16.0f;
+        static constexpr float          maxCutoff           = 20000.0f;
+        static constexpr float          maxEnvelopeTime     = 5.0f;     // Seconds
+        static constexpr float          maxDetune           = 100.0f;   // Cents
+        static constexpr float          minLfoRate          = 0.01f;
+        static constexpr float          maxLfoRate          = 100.0f;
+
+        struct LfoSettings
+        {
+            float           rate            = 1.0f;
+            LfoShape        shape           = LfoShape::sine;
+        };
+
+        juce::String    name                { "Init" };
+
+        float           mainLevel           = 0.05f;
+        float           subLevel            = 0.02f;
+        float           noiseLevel          = 0.01f;
+        NoiseColour     noiseColour         = NoiseColour::white;
+        bool            bandLimited         = true;
+        float           filterCutoff        = 1000.0f;
+        float           attack              = 0.005f;
+        float           decay               = 0.1f;
+        float           sustain             = 1.0f;
+        float           release             = 0.05f;
+        int             unisonVoices        = 1;
+        float           unisonDetune        = 20.0f;
+        float           unisonSpread        = 0.5f;
+
+        MainOscillator  mainOscillator      = MainOscillator::saw;
+        int             wavetable           = 0;
+        juce::String    wavetableFile;      // Full path of the .bgwt bank, empty for the built in one
+
+        std::array<LfoSettings, numLfos>                            lfos;
+        std::array<ModulationMatrix::Slot, ModulationMatrix::maxSlots> modulation;
+
+        juce::Result    limitRanges(void);
+
+        juce::ValueTree toValueTree(void) const;
+        juce::Result    fromValueTree(const juce::ValueTree& tree);
+
+        void            writeBinary(juce::OutputStream& stream) const;
+        juce::Result    readBinary(juce::InputStream& stream);
+
+        juce::Result    saveToFile(const juce::File& file) const;
+        juce::Result    loadFromFile(const juce::File& file);
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    PolyBlep.h
+    Created: 21 Dec 2024 10:26:14am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 1 to force the scalar kernels, e.g. for comparing against the SIMD ones
+#ifndef BGM01_DISABLE_SIMD
+ #define BGM01_DISABLE_SIMD 0
+#endif
+
+#if JUCE_USE_SIMD && ! BGM01_DISABLE_SIMD
+ #define BGM01_USE_SIMD 1
+#else
+ #define BGM01_USE_SIMD 0
+#endif
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // PolyBLEP helpers shared by the batched oscillator kernels
+    namespace PolyBlep
+    {
+        // @brief       PolyBLEP residual that smooths a unit step at phase 0
+        // @param       t = Phase in [0, 1)
+        //              dt = Phase increment per sample
+        //              invDt = 1 / dt
+        inline float blep(float t, float dt, float invDt)
+        {
+            if (t < dt)
+            {
+                t *= invDt;
+                return t + t - t * t - 1.0f;
+            }
+            else if (t > (1.0f - dt))
+            {
+                t = (t - 1.0f) * invDt;
+                return t * t + t + t + 1.0f;
+            }
+
+            return 0.0f;
+        }
+
+        // @brief       Function to wrap a phase back into [0, 1)
+        // @param       phase = Phase in [0, 2)
+        inline float wrap(float phase)
+        {
+            return phase - ((1.0f <= phase) ? 1.0f : 0.0f);
+        }
+
+       #if BGM01_USE_SIMD
+        using Vec   = juce::dsp::SIMDRegister<float>;
+
+        // @brief       Branch free PolyBLEP residual for a register of phases
+        // @param       t = Phases in [0, 1)
+        //              dt = Phase increments per sample
+        //              invDt = 1 / dt
+        inline Vec blep(Vec t, Vec dt, Vec invDt)
+        {
+            const Vec one = Vec::expand(1.0f);
+
+            // Just after the discontinuity
+            const Vec x     = t * invDt;
+            const Vec start = x + x - x * x - one;
+
+            // Just before the discontinuity, only one of the two can apply while dt < 0.5
+            const Vec y     = (t - one) * invDt;
+            const Vec end   = y * y + y + y + one;
+
+            return (start & Vec::lessThan(t, dt)) + (end & Vec::greaterThan(t, (one - dt)));
+        }
+
+        // @brief       Function to wrap phases back into [0, 1)
+        // @param       phase = Phases in [0, 2)
+        inline Vec wrap(Vec phase)
+        {
+            const Vec one = Vec::expand(1.0f);
+            return phase - (one & Vec::greaterThanOrEqual(phase, one));
+        }
+       #endif
+    }
+}
+//==============================================================================
\ No newline at end of file
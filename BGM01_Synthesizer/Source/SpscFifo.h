@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    SpscFifo.h
+    Created: 23 Nov 2024 4:18:33pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Lock-free single producer, single consumer queue of values, built on
+    // juce::AbstractFifo. The storage is allocated once in the constructor, so
+    // either side can run on the audio thread. When the queue is full new
+    // values are refused rather than overwriting ones not read yet.
+    template <typename T>
+    class SpscFifo
+    {
+    public:
+        // @brief       Constructor
+        // @param       capacity = Number of values the queue can hold
+        explicit SpscFifo(int capacity) :   _fifo(capacity + 1),
+                                            _items(static_cast<size_t>(capacity + 1))
+        {
+
+        }
+        ~SpscFifo()
+        {
+
+        }
+
+        // @brief       Producer: add a value
+        // @param       item = The value to add
+        // @return      False if the queue was full
+        bool push(const T& item)
+        {
+            return (1 == push(&item, 1));
+        }
+
+        // @brief       Producer: add as many values as fit
+        // @param       items = Values to add
+        //              numItems = Number of values
+        // @return      Number of values added
+        int push(const T* items, int numItems)
+        {
+            int start1, size1, start2, size2;
+            _fifo.prepareToWrite(numItems, start1, size1, start2, size2);
+
+            std::copy(items, (items + size1), (_items.begin() + start1));
+            std::copy((items + size1), (items + size1 + size2), (_items.begin() + start2));
+
+            _fifo.finishedWrite(size1 + size2);
+            return (size1 + size2);
+        }
+
+        // @brief       Consumer: take the oldest value
+        // @param       item = Set to the value taken
+        // @return      False if the queue was empty
+        bool pop(T& item)
+        {
+            return (1 == pop(&item, 1));
+        }
+
+        // @brief       Consumer: take up to the given number of values, oldest first
+        // @param       items = Where to put the values
+        //              numItems = Most values to take
+        // @return      Number of values taken
+        int pop(T* items, int numItems)
+        {
+            int start1, size1, start2, size2;
+            _fifo.prepareToRead(numItems, start1, size1, start2, size2);
+
+            std::copy((_items.begin() + start1), (_items.begin() + start1 + size1), items);
+            std::copy((_items.begin() + start2), (_items.begin() + start2 + size2), (items + size1));
+
+            _fifo.finishedRead(size1 + size2);
+            return (size1 + size2);
+        }
+
+        // @brief       Consumer: number of values waiting
+        // @param       None
+        int getNumReady(void) const
+        {
+            return _fifo.getNumReady();
+        }
+
+        // @brief       Producer: room left for values
+        // @param       None
+        int getFreeSpace(void) const
+        {
+            return _fifo.getFreeSpace();
+        }
+
+    private:
+        juce::AbstractFifo  _fifo;
+        std::vector<T>      _items;
+
+        JUCE_DECLARE_NON_COPYABLE(SpscFifo)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.cpp
+    Created: 20 Oct 2024 10:12:37am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "StateVariableFilter.h"
+#include "FastMath.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, defaults to a 1 kHz Butterworth low pass
+    StateVariableFilter::StateVariableFilter()
+    {
+        _ic1            = 0.0f;
+        _ic2            = 0.0f;
+        _cutoff         = 1000.0f;
+        _targetCutoff   = 1000.0f;
+        _k              = juce::MathConstants<float>::sqrt2;
+        _smoothingTime  = 0.005;
+        _countdown      = 0;
+
+        setSampleRate(44100.0);
+    }
+
+    // @brief       Function to set the rate the filter runs at
+    // @param       sampleRate = The sample rate in Hz
+    void StateVariableFilter::setSampleRate(double sampleRate)
+    {
+        _sampleRate = sampleRate;
+        _piOverRate = static_cast<float>(juce::MathConstants<double>::pi / sampleRate);
+
+        // Keep tan() away from its pole at Nyquist
+        _maxCutoff  = static_cast<float>(0.45 * sampleRate);
+
+        setSmoothingTime(_smoothingTime);
+        reset();
+    }
+
+    // @brief       Function to set the cutoff frequency, the filter glides to it
+    // @param       freq = Cutoff frequency in Hz
+    void StateVariableFilter::setCutoff(float freq)
+    {
+        _targetCutoff = juce::jlimit(10.0f, _maxCutoff, freq);
+    }
+
+    // @brief       Function to set the filter resonance
+    // @param       q = Quality factor, 1/sqrt(2) gives a Butterworth response
+    void StateVariableFilter::setResonance(float q)
+    {
+        _k          = 1.0f / juce::jmax(0.1f, q);
+        _countdown  = 0;
+    }
+
+    // @brief       Function to set how long the cutoff takes to reach a new value
+    // @param       seconds = Time constant of the glide
+    void StateVariableFilter::setSmoothingTime(double seconds)
+    {
+        _smoothingTime  = seconds;
+
+        // One pole glide, stepped once per control interval
+        _smoothing      = (0.0 < seconds) ? static_cast<float>(1.0 - std::exp(-controlInterval / (seconds * _sampleRate)))
+                                          : 1.0f;
+    }
+
+    // @brief       Function to clear the filter state and jump to the target cutoff
+    // @param       None
+    void StateVariableFilter::reset()
+    {
+        _ic1        = 0.0f;
+        _ic2        = 0.0f;
+        _cutoff     = juce::jlimit(10.0f, _maxCutoff, _targetCutoff);
+        _countdown  = 0;
+    }
+
+    // @brief       Function to step the cutoff glide and work out the coefficients
+    // @param       None
+    void StateVariableFilter::updateCoefficients()
+    {
+        _cutoff += (_targetCutoff - _cutoff) * _smoothing;
+
+        const float g = FastMath::tan(_cutoff * _piOverRate);
+
+        _a1 = 1.0f / (1.0f + (g * (g + _k)));
+        _a2 = g * _a1;
+        _a3 = g * _a2;
+    }
+
+    // @brief       Function for filtering a block in place
+    // @param       data = Samples to filter
+    //              numSamples = Number of samples to filter
+    void StateVariableFilter::process(float* data, int numSamples)
+    {
+        float ic1 = _ic1;
+        float ic2 = _ic2;
+
+        int sample = 0;
+        while (sample < numSamples)
+        {
+            if (0 >= _countdown)
+            {
+                updateCoefficients();
+                _countdown = controlInterval;
+            }
+
+            const int count = juce::jmin(_countdown, (numSamples - sample));
+            const float a1  = _a1;
+            const float a2  = _a2;
+            const float a3  = _a3;
+
+            for (int i = 0; i < count; i++)
+            {
+                const float v3 = data[sample + i] - ic2;
+                const float v1 = (a1 * ic1) + (a2 * v3);
+                const float v2 = ic2 + (a2 * ic1) + (a3 * v3);
+
+                ic1 = (2.0f * v1) - ic1;
+                ic2 = (2.0f * v2) - ic2;
+
+                data[sample + i] = v2;
+            }
+
+            sample      += count;
+            _countdown  -= count;
+        }
+
+        // Flush denormals once per block rather than every sample
+        _ic1 = juce::dsp::util::snapToZero(ic1);
+        _ic2 = juce::dsp::util::snapToZero(ic2);
+    }
+}
+//==============================================================================
\ No newline at end of file
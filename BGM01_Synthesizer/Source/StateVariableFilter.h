@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.h
+    Created: 20 Oct 2024 10:12:37am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Low pass state variable filter using the topology preserving transform
+    // (trapezoidal integrators). Unlike a biquad the TPT structure stays stable
+    // while its coefficients change, so the cutoff can be swept at audio rate.
+    // The cutoff glides towards its target and the coefficients are only worked
+    // out every controlInterval samples, using a fast tan() approximation.
+    class StateVariableFilter
+    {
+    public:
+        // Number of samples between coefficient updates
+        static constexpr int    controlInterval     = 8;
+
+        StateVariableFilter();
+        ~StateVariableFilter()
+        {
+
+        }
+
+        void    setSampleRate(double sampleRate);
+        void    setCutoff(float freq);
+        void    setResonance(float q);
+        void    setSmoothingTime(double seconds);
+        void    reset(void);
+
+        void    process(float* data, int numSamples);
+
+    private:
+        void    updateCoefficients(void);
+
+        // Filter state, i.e. the two integrator outputs
+        float   _ic1;
+        float   _ic2;
+
+        // Coefficients for the current control interval
+        float   _a1;
+        float   _a2;
+        float   _a3;
+        float   _k;
+
+        float   _cutoff;
+        float   _targetCutoff;
+        float   _maxCutoff;
+        float   _smoothing;
+        float   _piOverRate;
+        double  _smoothingTime;
+        double  _sampleRate;
+
+        // Samples left until the next coefficient update
+        int     _countdown;
+
+        JUCE_DECLARE_NON_COPYABLE(StateVariableFilter)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,1073 @@
+/*
+  ==============================================================================
+
+    SynthEngine.cpp
+    Created: 19 Oct 2024 3:05:52pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "SynthEngine.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Fewest voices worth handing to a thread, below this the hand over costs more than it saves
+    static constexpr int minVoicesPerJob = 4;
+
+    // @brief       Constructor, allocates the whole voice pool up front
+    SynthEngine::SynthEngine() : _voices(std::make_unique<SynthVoice[]>(maxVoices))
+    {
+        _numActive          = 0;
+        _usedVoices         = 0;
+        _voiceCounter       = 0;
+        _outputSilent       = true;
+        _sampleRate         = 44100.0;
+        _activeOrder        = 0;
+        _numChannels        = 1;
+        _noiseSeed          = 1;
+        _numThreads         = 1;
+        _jobNumSamples      = 0;
+        _jobLanes.fill(0);
+        _stepSize           = subBlockSize;
+        _modulated          = false;
+
+        _appliedPatch       = 0;
+        _swapPending        = false;
+        _fadeGain           = 1.0f;
+        _fadeStep           = static_cast<float>(1.0 / (patchFadeTime * _sampleRate));
+
+        // Give every voice its bank lane now, applying the settings needs it
+        for (int voice = 0; voice < maxVoices; voice++)
+        {
+            _voices[voice].prepare(_sampleRate, _bank, voice);
+        }
+
+        // The built in wavetables are small, a few FFTs each
+        _wavetableBanks.push_back(std::make_unique<WavetableBank>());
+        _wavetableBanks.front()->createBasic(WavetableBank::defaultTableSize);
+        _wavetablePaths.add(juce::String());
+        _edit.wavetables    = _wavetableBanks.front().get();
+
+        // Start from the default patch
+        publishSettings();
+        _settings.update();
+        applySettings(_settings.getReadBuffer());
+
+        // Set the filter order now so the filters never resize their state on the audio thread
+        *_outputChain.get<dcBlockerIndex>().state = juce::dsp::IIR::ArrayCoefficients<float>::makeFirstOrderHighPass(_sampleRate, 100.0f);
+    }
+
+    // @brief       Destructor
+    SynthEngine::~SynthEngine()
+    {
+        _workers.stop();
+    }
+
+    // @brief       Function to prepare the engine for playback, allocates everything
+    //              the audio thread will need
+    // @param       sampleRate = Device sample rate
+    //              maxBlockSize = Largest block expected from the device
+    //              numChannels = Channels to process, 1 for mono or 2 for stereo
+    void SynthEngine::prepare(double sampleRate, int maxBlockSize, int numChannels)
+    {
+        _sampleRate     = sampleRate;
+        _numChannels    = juce::jlimit(1, maxChannels, numChannels);
+
+        _mixBuffer.setSize(_numChannels, maxBlockSize);
+        _synthBuffer.setSize(_numChannels, (maxBlockSize << maxOversamplingOrder));
+        _voiceBuffer.setSize(1, (maxVoices * voiceStride));
+        _jobBuffer.setSize((_numChannels * (_numThreads - 1)), (maxBlockSize << maxOversamplingOrder));
+        _lfoValues.setSize(1, (numLfos * ((maxBlockSize / minControlInterval) + 1)));
+        _workers.start((_numThreads - 1), maxBlockSize, sampleRate);
+
+        juce::dsp::ProcessSpec specs = { (sampleRate * (1 << maxOversamplingOrder)),
+                                         static_cast<juce::uint32>(maxBlockSize << maxOversamplingOrder),
+                                         static_cast<juce::uint32>(_numChannels) };
+        _outputChain.prepare(specs);
+
+        // Every voice starts out free, voice n uses lane n of the oscillator bank
+        for (int voice = 0; voice < maxVoices; voice++)
+        {
+            _voices[voice].prepare(sampleRate, _bank, voice);
+            _voices[voice].setNoiseSeed((_noiseSeed * static_cast<juce::uint32>(maxVoices)) + static_cast<juce::uint32>(voice));
+        }
+        for (int lfo = 0; lfo < numLfos; lfo++)
+        {
+            _lfos[lfo].setSeed(_noiseSeed + static_cast<juce::uint32>(lfo));
+            _lfos[lfo].reset();
+        }
+        _numActive              = 0;
+        _usedVoices             = 0;
+        _outputSilent           = true;
+        _swapPending            = false;
+        _fadeGain               = 1.0f;
+        _fadeStep               = static_cast<float>(1.0 / (patchFadeTime * sampleRate));
+
+        // The voices were just reset to the device rate, so set the processing rate
+        // before the settings. Curves made for the old rate are worked out again.
+        _settings.update();
+        setProcessingOrder(_settings.getReadBuffer().oversamplingOrder);
+        applySettings(_settings.getReadBuffer());
+    }
+
+    // @brief       Function to release the playback resources
+    // @param       None
+    void SynthEngine::release()
+    {
+        _workers.stop();
+        _mixBuffer.setSize(0, 0);
+        _synthBuffer.setSize(0, 0);
+        _voiceBuffer.setSize(0, 0);
+        _jobBuffer.setSize(0, 0);
+        _lfoValues.setSize(0, 0);
+        _decimator.reset();
+    }
+
+    // @brief       Function for rendering the synth, replaces the contents of the buffer
+    // @param       buffer = Output buffer, extra channels repeat the last processed channel
+    //              startSample = First sample to render into
+    //              numSamples = Number of samples to render
+    // @return      False if the engine was silent for the whole block, the buffer
+    //              was only cleared and can be skipped by whatever comes next
+    bool SynthEngine::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        // Denormals are flushed by the CPU for the whole block rather than per sample
+        juce::ScopedNoDenormals noDenormals;
+
+        beginBlock();
+        return renderVoices(buffer, startSample, numSamples);
+    }
+
+    // @brief       Function for rendering the synth while playing the MIDI events of
+    //              the block, replaces the contents of the buffer
+    // @param       buffer = Output buffer, extra channels repeat the last processed channel
+    //              midi = Events for the block, positioned relative to the start of the buffer
+    //              startSample = First sample to render into
+    //              numSamples = Number of samples to render
+    // @return      False if the engine was silent for the whole block
+    bool SynthEngine::renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi,
+                                      int startSample, int numSamples)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        beginBlock();
+
+        // Render up to each event, then apply it, so notes start on the right sample
+        const int endSample = startSample + numSamples;
+        int position        = startSample;
+        bool audible        = false;
+
+        for (const auto metadata : midi)
+        {
+            const int eventPosition = juce::jlimit(startSample, endSample, metadata.samplePosition);
+            if (eventPosition > position)
+            {
+                audible     |= renderVoices(buffer, position, (eventPosition - position));
+                position    = eventPosition;
+            }
+
+            handleMidiEvent(metadata.data, metadata.numBytes);
+        }
+
+        if (position < endSample)
+        {
+            audible |= renderVoices(buffer, position, (endSample - position));
+        }
+
+        return audible;
+    }
+
+    // @brief       Function to start or stop notes for a MIDI event
+    // @param       data = The raw MIDI bytes
+    //              numBytes = Number of bytes
+    void SynthEngine::handleMidiEvent(const juce::uint8* data, int numBytes)
+    {
+        // Only channel voice messages matter here, and reading the bytes directly
+        // avoids building a MidiMessage, which allocates for long messages
+        if ((2 > numBytes) || (3 < numBytes))
+        {
+            return;
+        }
+
+        const int status    = data[0] & 0xf0;
+        const int note      = data[1] & 0x7f;
+        const int value     = (3 == numBytes) ? (data[2] & 0x7f) : 0;
+
+        if ((0x90 == status) && (0 < value))
+        {
+            noteOn(note, (value / 127.0f));
+        }
+        else if ((0x80 == status) || (0x90 == status))
+        {
+            noteOff(note);
+        }
+        else if ((0xb0 == status) && (120 == note))
+        {
+            allSoundOff();
+        }
+        else if ((0xb0 == status) && (123 == note))
+        {
+            allNotesOff();
+        }
+    }
+
+    // @brief       Function to apply the changes made since the last block
+    // @param       None
+    void SynthEngine::beginBlock()
+    {
+        // Pick up new settings once, at the block boundary
+        if (_settings.update())
+        {
+            const auto& settings = _settings.getReadBuffer();
+
+            // A new patch while sounding waits for the fade out, and so does
+            // anything changed after it
+            if ((_appliedPatch != settings.patchNumber) && (! (_outputSilent && (0 == _numActive))))
+            {
+                _swapPending = true;
+            }
+            else if (! _swapPending)
+            {
+                applySettings(settings);
+            }
+        }
+    }
+
+    // @brief       Function for rendering the voices into part of the buffer
+    // @param       buffer = Output buffer, extra channels repeat the last processed channel
+    //              startSample = First sample to render into
+    //              numSamples = Number of samples to render
+    // @return      False if nothing was rendered because the engine was silent
+    bool SynthEngine::renderVoices(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        // The device can hand over more samples than it said it would in prepare,
+        // so work through the block in chunks that fit the preallocated buffers
+        const int maxChunk = _mixBuffer.getNumSamples();
+        if (0 >= maxChunk)
+        {
+            return false;
+        }
+
+        bool audible = false;
+        for (int offset = 0, chunkSize = 0; offset < numSamples; offset += chunkSize)
+        {
+            // The waiting patch goes in once the fade out is over, or everything has stopped
+            if (_swapPending && ((0.0f == _fadeGain) || (_outputSilent && (0 == _numActive))))
+            {
+                applySettings(_settings.getReadBuffer());
+            }
+
+            // Nothing playing and nothing left ringing, so skip the voices, filters and
+            // oversampling for the rest of the block. A block cleared from the start is
+            // also marked as silent for the host.
+            if (_outputSilent && (0 == _numActive))
+            {
+                buffer.clear((startSample + offset), (numSamples - offset));
+
+                // Nothing is left to fade back in, the next note starts at full level
+                _fadeGain = 1.0f;
+                return audible;
+            }
+
+            // A chunk ends where the fade out does, so the new patch takes over on
+            // the next sample rather than at the next block
+            chunkSize = juce::jmin(maxChunk, (numSamples - offset));
+            if (_swapPending)
+            {
+                chunkSize = juce::jmin(chunkSize, juce::jmax(1, static_cast<int>(std::ceil(_fadeGain / _fadeStep))));
+            }
+
+            juce::dsp::AudioBlock<float> mixBlock = juce::dsp::AudioBlock<float>(_mixBuffer).getSubBlock(0, static_cast<size_t>(chunkSize));
+
+            // When oversampling the voices render into the larger buffer, which is
+            // only brought down afterwards, there is nothing to upsample first
+            juce::dsp::AudioBlock<float> synthBlock = mixBlock;
+            if (0 < _activeOrder)
+            {
+                synthBlock = juce::dsp::AudioBlock<float>(_synthBuffer).getSubBlock(0, static_cast<size_t>(chunkSize << _activeOrder));
+            }
+            synthBlock.clear();
+            renderLfos(static_cast<int>(synthBlock.getNumSamples()));
+
+            // Share the voices out, the first job mixes straight into the block
+            const int numJobs   = planJobs();
+            _jobNumSamples      = static_cast<int>(synthBlock.getNumSamples());
+            for (int job = 0; job < numJobs; job++)
+            {
+                for (int channel = 0; channel < _numChannels; channel++)
+                {
+                    _jobOutput[job][channel] = (0 == job) ? synthBlock.getChannelPointer(static_cast<size_t>(channel))
+                                                          : _jobBuffer.getWritePointer(((job - 1) * _numChannels) + channel);
+                }
+            }
+
+            _workers.run(*this, numJobs);
+
+            // Summed in job order, so the output doesn't depend on which thread ran what
+            for (int job = 1; job < numJobs; job++)
+            {
+                for (int channel = 0; channel < _numChannels; channel++)
+                {
+                    juce::FloatVectorOperations::add(_jobOutput[0][channel], _jobOutput[job][channel], _jobNumSamples);
+                }
+            }
+
+            removeFinishedVoices();
+
+            // Output filtering runs on whole blocks, the state carries over between them
+            juce::dsp::ProcessContextReplacing<float> context(synthBlock);
+            _outputChain.process(context);
+
+            if (0 < _activeOrder)
+            {
+                _decimator.process(synthBlock, mixBlock);
+            }
+
+            applyFade(chunkSize);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+            {
+                const int source = juce::jmin(channel, (_numChannels - 1));
+                buffer.copyFrom(channel, (startSample + offset), _mixBuffer.getReadPointer(source), chunkSize);
+            }
+
+            checkForSilence(chunkSize);
+            audible = true;
+        }
+
+        return audible;
+    }
+
+    // @brief       Function to step the LFOs through the chunk about to be rendered
+    // @param       numSamples = Length of the chunk at the processing rate
+    // @note        Fills _lfoValues with the values for each control step
+    void SynthEngine::renderLfos(int numSamples)
+    {
+        // The interval is in device samples, capped so a step never spans two sub-blocks
+        _stepSize = juce::jmin(subBlockSize, (_controlInterval << _activeOrder));
+
+        // Nothing reads the LFOs, but they keep time so they don't jump when routed
+        if (! _modulated)
+        {
+            for (auto& lfo : _lfos)
+            {
+                lfo.advance(numSamples);
+            }
+            return;
+        }
+
+        auto* values = _lfoValues.getWritePointer(0);
+        for (int position = 0; position < numSamples; position += _stepSize)
+        {
+            const int size = juce::jmin(_stepSize, (numSamples - position));
+            for (auto& lfo : _lfos)
+            {
+                *values++ = lfo.advance(size);
+            }
+        }
+    }
+
+    // @brief       Function to fade the mix out while a patch waits, and back in after
+    // @param       numSamples = Number of samples in the mix buffer
+    void SynthEngine::applyFade(int numSamples)
+    {
+        const float target = _swapPending ? 0.0f : 1.0f;
+        if (target == _fadeGain)
+        {
+            return;
+        }
+
+        // Ramp towards the target, then hold it for the rest of the chunk
+        const int rampLength    = juce::jmin(numSamples, static_cast<int>(std::ceil(std::abs(target - _fadeGain) / _fadeStep)));
+        const float change      = rampLength * _fadeStep;
+        const float endGain     = (0.0f == target) ? juce::jmax(0.0f, (_fadeGain - change)) : juce::jmin(1.0f, (_fadeGain + change));
+
+        _mixBuffer.applyGainRamp(0, rampLength, _fadeGain, endGain);
+        if ((0.0f == target) && (rampLength < numSamples))
+        {
+            _mixBuffer.clear(rampLength, (numSamples - rampLength));
+        }
+
+        _fadeGain = endGain;
+    }
+
+    // @brief       Function to split the active voices into jobs, one per thread at most
+    // @param       None
+    // @return      Number of jobs, their lanes are in _jobLanes
+    int SynthEngine::planJobs()
+    {
+        // The thread count set since prepare isn't used until the next one
+        const int numThreads = _workers.getNumWorkers() + 1;
+        if ((1 == numThreads) || ((minVoicesPerJob * 2) > _numActive))
+        {
+            _jobLanes[0] = _usedVoices;
+            return 1;
+        }
+
+        // Fill each job up to an even share, whole lane groups at a time
+        const int share             = juce::jmax(minVoicesPerJob, ((_numActive + numThreads - 1) / numThreads));
+        const juce::uint64 groupMask = ((juce::uint64(1) << laneGroupSize) - 1);
+
+        int numJobs         = 0;
+        int numVoices       = 0;
+        juce::uint64 lanes  = 0;
+
+        for (int group = 0; group < numLaneGroups; group++)
+        {
+            const juce::uint64 groupLanes = _usedVoices & (groupMask << (group * laneGroupSize));
+            if (0 == groupLanes)
+            {
+                continue;
+            }
+
+            lanes       |= groupLanes;
+            numVoices   += juce::countNumberOfBits(groupLanes);
+
+            if ((share <= numVoices) && (numJobs < (numThreads - 1)))
+            {
+                _jobLanes[numJobs++]    = lanes;
+                lanes                   = 0;
+                numVoices               = 0;
+            }
+        }
+
+        if (0 != lanes)
+        {
+            _jobLanes[numJobs++] = lanes;
+        }
+
+        return numJobs;
+    }
+
+    // @brief       Function to render one job's voices, may run on any thread
+    // @param       index = The job to run
+    void SynthEngine::runJob(int index)
+    {
+        const juce::uint64 lanes    = _jobLanes[index];
+        const int numSamples        = _jobNumSamples;
+        auto* voice_buf             = _voiceBuffer.getWritePointer(0);
+        auto* left_buf              = _jobOutput[index][0];
+        auto* right_buf             = (1 < _numChannels) ? _jobOutput[index][1] : nullptr;
+
+        // The first job renders into the cleared block, the rest into their own buffers
+        if (0 < index)
+        {
+            juce::FloatVectorOperations::clear(left_buf, numSamples);
+            if (nullptr != right_buf)
+            {
+                juce::FloatVectorOperations::clear(right_buf, numSamples);
+            }
+        }
+
+        // With modulation the voices are rendered a control step at a time, which
+        // divides the sub-block size, so the work buffers are never overrun
+        const int stepSize      = _modulated ? _stepSize : subBlockSize;
+        const float* lfo_values = _lfoValues.getReadPointer(0);
+
+        for (int sub = 0; sub < numSamples; sub += stepSize)
+        {
+            const int subSize = juce::jmin(stepSize, (numSamples - sub));
+
+            if (_modulated)
+            {
+                for (int active = 0; active < _numActive; active++)
+                {
+                    auto& voice = _voices[_activeVoices[active]];
+                    if (0 != ((lanes >> voice.getLane()) & 1))
+                    {
+                        voice.modulate(_matrix, lfo_values);
+                    }
+                }
+                lfo_values += numLfos;
+            }
+
+            // The bank renders the main and sub oscillators of the job's voices
+            // together, then each voice adds noise and filters its own lane
+            _bank.render(lanes, voice_buf, voiceStride, subSize);
+            for (int active = 0; active < _numActive; active++)
+            {
+                auto& voice = _voices[_activeVoices[active]];
+                if (0 == ((lanes >> voice.getLane()) & 1))
+                {
+                    continue;
+                }
+
+                auto* osc_buf = voice_buf + (voice.getLane() * voiceStride);
+                voice.render((left_buf + sub), ((nullptr != right_buf) ? (right_buf + sub) : nullptr),
+                             osc_buf, (osc_buf + subBlockSize), subSize);
+            }
+        }
+    }
+
+    // @brief       Function to stop processing once the voices and the tail have died away
+    // @param       numSamples = Number of samples just rendered into the mix buffer
+    void SynthEngine::checkForSilence(int numSamples)
+    {
+        // Only worth looking at the output once every voice has finished
+        if ((0 < _numActive) || (silenceThreshold <= _mixBuffer.getMagnitude(0, numSamples)))
+        {
+            return;
+        }
+
+        // What is left in the filters is inaudible, drop it so it can't come back later
+        _outputChain.reset();
+        _decimator.reset();
+        _outputSilent = true;
+    }
+
+    // @brief       Function to start a note
+    // @param       midiNoteNumber = Note to play
+    //              velocity = Note on velocity
+    void SynthEngine::noteOn(int midiNoteNumber, float velocity)
+    {
+        const int index = allocateVoice(midiNoteNumber);
+        if (0 > index)
+        {
+            return;
+        }
+
+        auto& voice = _voices[index];
+
+        // A stolen voice fades out and restarts from silence rather than jumping to the new note
+        if (voice.isActive() && (midiNoteNumber != voice.getNote()))
+        {
+            voice.steal(midiNoteNumber, velocity, ++_voiceCounter);
+        }
+        else
+        {
+            voice.start(midiNoteNumber, velocity, ++_voiceCounter);
+        }
+        _outputSilent = false;
+    }
+
+    // @brief       Function to release a note
+    // @param       midiNoteNumber = Note to release
+    void SynthEngine::noteOff(int midiNoteNumber)
+    {
+        for (int active = 0; active < _numActive; active++)
+        {
+            auto& voice = _voices[_activeVoices[active]];
+            if (voice.isGateOn() && (midiNoteNumber == voice.getNote()))
+            {
+                voice.stop();
+            }
+        }
+    }
+
+    // @brief       Function to release every playing note
+    // @param       None
+    void SynthEngine::allNotesOff()
+    {
+        for (int active = 0; active < _numActive; active++)
+        {
+            _voices[_activeVoices[active]].stop();
+        }
+    }
+
+    // @brief       Function to silence everything at once, without the release
+    // @param       None
+    void SynthEngine::allSoundOff()
+    {
+        for (int active = 0; active < _numActive; active++)
+        {
+            _voices[_activeVoices[active]].kill();
+        }
+        removeFinishedVoices();
+
+        // Nothing may ring on in the output filters either
+        _outputChain.reset();
+        _decimator.reset();
+        _outputSilent = true;
+    }
+
+    // @brief       Function to switch to another patch. Everything it needs is worked
+    //              out here, the audio thread fades over to it at the next block.
+    // @param       patch = The patch, copied
+    juce::Result SynthEngine::loadPatch(const Patch& patch)
+    {
+        // Patches made in code haven't been through loadFromFile's checks
+        Patch limited = patch;
+        auto result = limited.limitRanges();
+        if (result.failed())
+        {
+            return result;
+        }
+
+        // A bank file that can't be mapped leaves the patch on the built in bank
+        const WavetableBank* bank = _wavetableBanks.front().get();
+        result = findWavetables(limited.wavetableFile, bank);
+
+        _edit.patch         = limited;
+        _edit.wavetables    = bank;
+        _edit.patchNumber++;
+        publishSettings();
+        return result;
+    }
+
+    // @brief       Function to set how many voices can play at once
+    // @param       numVoices = Number of voices, limited to the pool size
+    void SynthEngine::setPolyphony(int numVoices)
+    {
+        _edit.polyphony = juce::jlimit(1, maxVoices, numVoices);
+        publishSettings();
+    }
+
+    // @brief       Function to set which voice is stolen when all are busy
+    // @param       policy = The stealing policy
+    void SynthEngine::setStealPolicy(StealPolicy policy)
+    {
+        _edit.stealPolicy = policy;
+        publishSettings();
+    }
+
+    // @brief       Function to set whether a repeated note reuses its voice
+    // @param       retrigger = True to retrigger the voice already playing the note
+    void SynthEngine::setRetriggerSameNote(bool retrigger)
+    {
+        _edit.retriggerSameNote = retrigger;
+        publishSettings();
+    }
+
+    // @brief       Function to choose what plays the main oscillator, fades over like a new patch
+    // @param       type = Saw or wavetable
+    void SynthEngine::setMainOscillator(MainOscillator type)
+    {
+        _edit.patch.mainOscillator = type;
+        _edit.patchNumber++;
+        publishSettings();
+    }
+
+    // @brief       Function to choose the table the wavetable oscillator plays, fades over like a new patch
+    // @param       table = Table in the bank, from 0
+    void SynthEngine::setWavetable(int table)
+    {
+        _edit.patch.wavetable = juce::jlimit(0, (getNumWavetables() - 1), table);
+        _edit.patchNumber++;
+        publishSettings();
+    }
+
+    // @brief       Function to choose the bank the wavetables are read from
+    // @param       path = Full path of a .bgwt file, or empty for the built in bank
+    // @return      Failed if the file could not be mapped, the bank is left as it was
+    juce::Result SynthEngine::setWavetableFile(const juce::String& path)
+    {
+        const WavetableBank* bank = nullptr;
+        const auto result = findWavetables(path, bank);
+        if (result.failed())
+        {
+            return result;
+        }
+
+        _edit.patch.wavetableFile   = path;
+        _edit.patch.wavetable       = juce::jmin(_edit.patch.wavetable, (bank->getNumTables() - 1));
+        _edit.wavetables            = bank;
+        _edit.patchNumber++;
+        publishSettings();
+        return result;
+    }
+
+    // @brief       Function to set the main oscillator level
+    // @param       lvl = The level to set to
+    void SynthEngine::setMainLevel(float lvl)
+    {
+        _edit.patch.mainLevel = juce::jlimit(0.0f, Patch::maxLevel, lvl);
+        publishSettings();
+    }
+
+    // @brief       Function to set the sub oscillator level
+    // @param       lvl = The level to set to
+    void SynthEngine::setSubLevel(float lvl)
+    {
+        _edit.patch.subLevel = juce::jlimit(0.0f, Patch::maxLevel, lvl);
+        publishSettings();
+    }
+
+    // @brief       Function to set the noise level
+    // @param       lvl = The level to set to
+    void SynthEngine::setNoiseLevel(float lvl)
+    {
+        _edit.patch.noiseLevel = juce::jlimit(0.0f, Patch::maxLevel, lvl);
+        publishSettings();
+    }
+
+    // @brief       Function to set the colour of the noise
+    // @param       colour = White, pink or brown
+    void SynthEngine::setNoiseColour(NoiseColour colour)
+    {
+        _edit.patch.noiseColour = colour;
+        publishSettings();
+    }
+
+    // @brief       Function to set the low pass filter cutoff
+    // @param       freq = Cutoff frequency in Hz
+    void SynthEngine::setFilterCutoff(float freq)
+    {
+        _edit.patch.filterCutoff = juce::jlimit(Patch::minCutoff, Patch::maxCutoff, freq);
+        publishSettings();
+    }
+
+    // @brief       Function to set the envelope attack time
+    // @param       seconds = Time to rise from silence to full level
+    void SynthEngine::setAttack(float seconds)
+    {
+        _edit.patch.attack = juce::jlimit(0.0f, Patch::maxEnvelopeTime, seconds);
+        publishSettings();
+    }
+
+    // @brief       Function to set the envelope decay time
+    // @param       seconds = Time to fall from full level to the sustain level
+    void SynthEngine::setDecay(float seconds)
+    {
+        _edit.patch.decay = juce::jlimit(0.0f, Patch::maxEnvelopeTime, seconds);
+        publishSettings();
+    }
+
+    // @brief       Function to set the envelope sustain level
+    // @param       lvl = Level held while the key is down, from 0 to 1
+    void SynthEngine::setSustain(float lvl)
+    {
+        _edit.patch.sustain = juce::jlimit(0.0f, 1.0f, lvl);
+        publishSettings();
+    }
+
+    // @brief       Function to set the envelope release time
+    // @param       seconds = Time to fall from full level to silence after note off
+    void SynthEngine::setRelease(float seconds)
+    {
+        _edit.patch.release = juce::jlimit(0.0f, Patch::maxEnvelopeTime, seconds);
+        publishSettings();
+    }
+
+    // @brief       Function to set the number of saws stacked on the main oscillator
+    // @param       numOscillators = 1 for a single saw, up to UnisonOscillator::maxOscillators
+    void SynthEngine::setUnisonVoices(int numOscillators)
+    {
+        _edit.patch.unisonVoices = juce::jlimit(1, UnisonOscillator::maxOscillators, numOscillators);
+        publishSettings();
+    }
+
+    // @brief       Function to set how far apart the unison saws are tuned
+    // @param       cents = Detune of the outermost saws from the note
+    void SynthEngine::setUnisonDetune(float cents)
+    {
+        _edit.patch.unisonDetune = juce::jlimit(0.0f, Patch::maxDetune, cents);
+        publishSettings();
+    }
+
+    // @brief       Function to set the stereo width of the unison saws
+    // @param       spread = 0 for mono, 1 to pan the outermost saws hard left and right
+    void SynthEngine::setUnisonSpread(float spread)
+    {
+        _edit.patch.unisonSpread = juce::jlimit(0.0f, 1.0f, spread);
+        publishSettings();
+    }
+
+    // @brief       Function to select band limited or naive oscillators
+    // @param       bandLimited = True for PolyBLEP oscillators
+    void SynthEngine::setBandLimited(bool bandLimited)
+    {
+        _edit.patch.bandLimited = bandLimited;
+        publishSettings();
+    }
+
+    // @brief       Function to set the oversampling factor, applied at the next block
+    // @param       order = Oversampling order, i.e. factor = 2^order (0 is off)
+    void SynthEngine::setOversamplingOrder(int order)
+    {
+        _edit.oversamplingOrder = juce::jlimit(0, maxOversamplingOrder, order);
+        publishSettings();
+    }
+
+    // @brief       Function to set the speed of an LFO
+    // @param       lfo = Which LFO, from 0
+    //              hz = Frequency in Hz
+    void SynthEngine::setLfoRate(int lfo, float hz)
+    {
+        if (juce::isPositiveAndBelow(lfo, numLfos))
+        {
+            _edit.patch.lfos[static_cast<size_t>(lfo)].rate = juce::jlimit(Patch::minLfoRate, Patch::maxLfoRate, hz);
+            publishSettings();
+        }
+    }
+
+    // @brief       Function to set the waveform of an LFO
+    // @param       lfo = Which LFO, from 0
+    //              shape = The waveform
+    void SynthEngine::setLfoShape(int lfo, LfoShape shape)
+    {
+        if (juce::isPositiveAndBelow(lfo, numLfos))
+        {
+            _edit.patch.lfos[static_cast<size_t>(lfo)].shape = shape;
+            publishSettings();
+        }
+    }
+
+    // @brief       Function to route a modulation source to a destination
+    // @param       slot = Matrix slot, from 0 to ModulationMatrix::maxSlots - 1
+    //              source = Where the modulation comes from
+    //              destination = What it changes
+    //              amount = Depth from -1 to 1, 0 turns the slot off
+    void SynthEngine::setModulation(int slot, ModSource source, ModDestination destination, float amount)
+    {
+        if (juce::isPositiveAndBelow(slot, ModulationMatrix::maxSlots))
+        {
+            _edit.patch.modulation[static_cast<size_t>(slot)] = { source, destination, juce::jlimit(-1.0f, 1.0f, amount) };
+            publishSettings();
+        }
+    }
+
+    // @brief       Function to set how often the modulation is worked out
+    // @param       numSamples = Control interval in samples, rounded up to a power of
+    //                           two from minControlInterval to subBlockSize
+    void SynthEngine::setControlInterval(int numSamples)
+    {
+        _edit.controlInterval = juce::nextPowerOfTwo(juce::jlimit(minControlInterval, subBlockSize, numSamples));
+        publishSettings();
+    }
+
+    // @brief       Function to find a voice for a new note
+    // @param       midiNoteNumber = Note to play
+    // @return      Index of the voice to use, which may need stealing
+    int SynthEngine::allocateVoice(int midiNoteNumber)
+    {
+        if (_retriggerSameNote)
+        {
+            for (int active = 0; active < _numActive; active++)
+            {
+                if (midiNoteNumber == _voices[_activeVoices[active]].getNote())
+                {
+                    return _activeVoices[active];
+                }
+            }
+        }
+
+        // Take the lowest free voice, which keeps the active lanes of the oscillator
+        // bank packed into as few SIMD registers as possible
+        if (_numActive < _polyphony)
+        {
+            for (int index = 0; index < maxVoices; index++)
+            {
+                const juce::uint64 bit = (juce::uint64(1) << index);
+                if (0 == (_usedVoices & bit))
+                {
+                    _usedVoices                |= bit;
+                    _activeVoices[_numActive++] = index;
+                    return index;
+                }
+            }
+        }
+
+        return findVoiceToSteal();
+    }
+
+    // @brief       Function to pick the voice to steal, released voices go first
+    // @param       None
+    // @return      Index of the voice to steal, -1 if there are no active voices
+    int SynthEngine::findVoiceToSteal() const
+    {
+        int     best        = -1;
+        bool    bestGateOn  = true;
+
+        for (int active = 0; active < _numActive; active++)
+        {
+            const int   index   = _activeVoices[active];
+            const auto& voice   = _voices[index];
+
+            if (0 > best)
+            {
+                best        = index;
+                bestGateOn  = voice.isGateOn();
+                continue;
+            }
+
+            // Always prefer a voice that is already fading out
+            if (voice.isGateOn() != bestGateOn)
+            {
+                if (! voice.isGateOn())
+                {
+                    best        = index;
+                    bestGateOn  = false;
+                }
+                continue;
+            }
+
+            const auto& current = _voices[best];
+            bool better = false;
+            switch (_stealPolicy)
+            {
+                case StealPolicy::quietest:
+                    better = (voice.getLevel() < current.getLevel());
+                    break;
+
+                case StealPolicy::oldest:
+                default:
+                    better = (voice.getAge() < current.getAge());
+                    break;
+            }
+
+            if (better)
+            {
+                best = index;
+            }
+        }
+
+        return best;
+    }
+
+    // @brief       Function to return voices that have finished to the free list
+    // @param       None
+    void SynthEngine::removeFinishedVoices()
+    {
+        for (int active = 0; active < _numActive;)
+        {
+            const int index = _activeVoices[active];
+            if (_voices[index].isActive())
+            {
+                active++;
+            }
+            else
+            {
+                // Swap with the last active voice to keep the list packed
+                _activeVoices[active]   = _activeVoices[--_numActive];
+                _usedVoices            &= ~(juce::uint64(1) << index);
+            }
+        }
+    }
+
+    // @brief       Function to switch the oversampling factor
+    // @param       order = Oversampling order, i.e. factor = 2^order (0 is off)
+    void SynthEngine::setProcessingOrder(int order)
+    {
+        order = juce::jlimit(0, maxOversamplingOrder, order);
+
+        // The voices and filters run at the oversampled rate
+        const double rate = _sampleRate * (1 << order);
+        _bank.setSampleRate(rate);
+        for (int voice = 0; voice < maxVoices; voice++)
+        {
+            _voices[voice].setSampleRate(rate);
+        }
+        for (auto& lfo : _lfos)
+        {
+            lfo.setSampleRate(rate);
+        }
+
+        // Same filter order as before, so this reuses the coefficient storage
+        *_outputChain.get<dcBlockerIndex>().state = juce::dsp::IIR::ArrayCoefficients<float>::makeFirstOrderHighPass(rate, 100.0f);
+        _outputChain.reset();
+        _activeOrder = order;
+        _decimator.setOrder(order);
+    }
+
+    // @brief       Function to hand the settings over to the audio thread, with the
+    //              curves and routing the voices need already worked out
+    // @param       None
+    // @note        Message thread only
+    void SynthEngine::publishSettings()
+    {
+        const auto& patch   = _edit.patch;
+        auto& settings      = _settings.getWriteBuffer();
+
+        settings                = _edit;
+        settings.processingRate = _sampleRate.load() * (1 << _edit.oversamplingOrder);
+        settings.envelope       = Envelope::makeShape(patch.attack, patch.decay, patch.sustain, patch.release, settings.processingRate);
+        settings.unison         = UnisonOscillator::makeStack(patch.unisonVoices, patch.unisonDetune, patch.unisonSpread);
+
+        settings.matrix.clear();
+        for (int slot = 0; slot < ModulationMatrix::maxSlots; slot++)
+        {
+            const auto& routing = patch.modulation[static_cast<size_t>(slot)];
+            settings.matrix.setSlot(slot, routing.source, routing.destination, routing.amount);
+        }
+
+        _settings.publish();
+    }
+
+    // @brief       Function to find the bank for a file, mapping it the first time
+    // @param       path = Full path of a .bgwt file, or empty for the built in bank
+    //              bank = Set to the bank, left alone if it fails
+    // @return      Failed if the file could not be mapped
+    // @note        Message thread only
+    juce::Result SynthEngine::findWavetables(const juce::String& path, const WavetableBank*& bank)
+    {
+        const int index = _wavetablePaths.indexOf(path);
+        if (0 <= index)
+        {
+            bank = _wavetableBanks[static_cast<size_t>(index)].get();
+            return juce::Result::ok();
+        }
+
+        if (! juce::File::isAbsolutePath(path))
+        {
+            return juce::Result::fail("Wavetable files need a full path: " + path);
+        }
+
+        auto mapped = std::make_unique<WavetableBank>();
+        const auto result = mapped->loadFromFile(juce::File(path));
+        if (result.failed())
+        {
+            return result;
+        }
+
+        bank = mapped.get();
+        _wavetableBanks.push_back(std::move(mapped));
+        _wavetablePaths.add(path);
+        return result;
+    }
+
+    // @brief       Function to switch the audio thread over to a set of settings
+    // @param       settings = The settings, from publishSettings
+    // @note        Audio thread only, or prepare
+    void SynthEngine::applySettings(const Settings& settings)
+    {
+        const auto& patch   = settings.patch;
+
+        _appliedPatch       = settings.patchNumber;
+        _swapPending        = false;
+        _polyphony          = settings.polyphony;
+        _stealPolicy        = settings.stealPolicy;
+        _retriggerSameNote  = settings.retriggerSameNote;
+        _controlInterval    = settings.controlInterval;
+
+        if (settings.oversamplingOrder != _activeOrder)
+        {
+            setProcessingOrder(settings.oversamplingOrder);
+        }
+
+        // The curves only need working out here if the device rate changed after they were made
+        const double rate           = _sampleRate.load() * (1 << _activeOrder);
+        const Envelope::Shape shape = (rate == settings.processingRate) ? settings.envelope
+                                    : Envelope::makeShape(patch.attack, patch.decay, patch.sustain, patch.release, rate);
+
+        for (int lfo = 0; lfo < numLfos; lfo++)
+        {
+            _lfos[lfo].setRate(patch.lfos[static_cast<size_t>(lfo)].rate);
+            _lfos[lfo].setShape(patch.lfos[static_cast<size_t>(lfo)].shape);
+        }
+        _matrix             = settings.matrix;
+        _modulated          = _matrix.isActive();
+
+        // The voice filters glide to the new cutoff, so there is nothing to redesign
+        for (int voice = 0; voice < maxVoices; voice++)
+        {
+            _voices[voice].setMainOscillator(patch.mainOscillator, settings.wavetables, patch.wavetable);
+            _voices[voice].setLevels(patch.mainLevel, patch.subLevel, patch.noiseLevel);
+            _voices[voice].setNoiseColour(patch.noiseColour);
+            _voices[voice].setFilterCutoff(patch.filterCutoff);
+            _voices[voice].setEnvelope(shape);
+            _voices[voice].setUnison(settings.unison);
+            _voices[voice].setBandLimited(patch.bandLimited);
+
+            // Nothing will modulate the voices, so put them back where they would be without it
+            if (! _modulated)
+            {
+                _voices[voice].clearModulation();
+            }
+        }
+        _bank.setBandLimited(patch.bandLimited);
+    }
+}
+//==============================================================================
\ No newline at end of file
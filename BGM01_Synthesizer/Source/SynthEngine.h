@@ -0,0 +1,262 @@
+/*
+  ==============================================================================
+
+    SynthEngine.h
+    Created: 19 Oct 2024 3:05:52pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SynthVoice.h"
+#include "WorkerPool.h"
+#include "Lfo.h"
+#include "ModulationMatrix.h"
+#include "Patch.h"
+#include "TripleBuffer.h"
+#include "Decimator.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Polyphonic synth engine, owns the voice pool, oversampling and the output
+    // filtering. Independent of the GUI so it can be driven by any audio callback.
+    // The setters are safe to call from the message thread while rendering. With
+    // more than one thread, the voices are split across a worker pool by groups
+    // of oscillator bank lanes, each group mixing into its own buffer.
+    //
+    // Modulation runs at control rate. The LFOs are stepped and the matrix is
+    // evaluated for every voice once per control interval, which is what makes
+    // it affordable at full polyphony. With no modulation routed the voices are
+    // rendered in whole sub-blocks as before.
+    //
+    // Settings reach the audio thread as whole snapshots. Every change on the
+    // message thread works out what the voices need from it (envelope curves,
+    // unison detune and gains, the modulation routing) and publishes a copy
+    // through a triple buffer, so the audio thread never sees half a change
+    // and only copies values in. A new patch fades the output out, is swapped
+    // in at silence and fades back in, so switching sounds mid-note doesn't click.
+    //
+    // Wavetable banks are made or mapped on the message thread too, the built in
+    // one when the engine is made and a bank file the first time a patch names
+    // it. They are kept until the engine goes, so a voice never reads a bank
+    // that has been unmapped.
+    class SynthEngine : private WorkerPool::Job
+    {
+    public:
+        static constexpr int    maxVoices               = OscillatorBank::maxLanes;
+        static constexpr int    maxOversamplingOrder    = 3;
+        static constexpr int    maxChannels             = 2;
+
+        // Voices are rendered in sub-blocks of this size so the per voice buffers
+        // stay in cache
+        static constexpr int    subBlockSize            = 128;
+
+        // Each voice gets two sub-blocks of work space, the second is the right
+        // channel of stereo unison
+        static constexpr int    voiceStride             = 2 * subBlockSize;
+
+        // Voices are shared out between threads in groups of this many lanes, a
+        // whole number of SIMD registers so no two threads touch the same one
+        static constexpr int    laneGroupSize           = 8;
+        static constexpr int    numLaneGroups           = maxVoices / laneGroupSize;
+        static constexpr int    maxThreads              = numLaneGroups;
+
+        // Modulation is worked out once per this many samples, a power of two. It
+        // is counted at the device rate, so oversampling doesn't make it dearer.
+        static constexpr int    numLfos                 = Patch::numLfos;
+        static constexpr int    minControlInterval      = 8;
+        static constexpr int    defaultControlInterval  = 32;
+
+        // Once no voice is playing and the output tail is below this (about -100 dB)
+        // the engine stops processing until the next note
+        static constexpr float  silenceThreshold        = 1.0e-5f;
+
+        // Length of the fade out before a new patch is swapped in, and of the fade
+        // back in after, in seconds. A silent engine swaps straight away.
+        static constexpr float  patchFadeTime           = 0.005f;
+
+        // Which voice is taken when a note arrives and all voices are busy
+        enum class StealPolicy
+        {
+            oldest,
+            quietest
+        };
+
+        SynthEngine();
+        ~SynthEngine() override;
+
+        void    prepare(double sampleRate, int maxBlockSize, int numChannels = maxChannels);
+        void    release(void);
+        bool    renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+        bool    renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi,
+                                int startSample, int numSamples);
+
+        // Audio thread side, called between blocks or from the MIDI in renderNextBlock
+        void    noteOn(int midiNoteNumber, float velocity);
+        void    noteOff(int midiNoteNumber);
+        void    allNotesOff(void);
+        void    allSoundOff(void);
+
+        // Message thread side, applied by the audio thread at the next block
+        juce::Result    loadPatch(const Patch& patch);
+        void    setPolyphony(int numVoices);
+        void    setStealPolicy(StealPolicy policy);
+        void    setRetriggerSameNote(bool retrigger);
+
+        void    setMainOscillator(MainOscillator type);
+        void    setWavetable(int table);
+        juce::Result    setWavetableFile(const juce::String& path);
+        void    setMainLevel(float lvl);
+        void    setSubLevel(float lvl);
+        void    setNoiseLevel(float lvl);
+        void    setNoiseColour(NoiseColour colour);
+        void    setFilterCutoff(float freq);
+        void    setAttack(float seconds);
+        void    setDecay(float seconds);
+        void    setSustain(float lvl);
+        void    setRelease(float seconds);
+        void    setUnisonVoices(int numOscillators);
+        void    setUnisonDetune(float cents);
+        void    setUnisonSpread(float spread);
+        void    setBandLimited(bool bandLimited);
+        void    setOversamplingOrder(int order);
+        void    setLfoRate(int lfo, float hz);
+        void    setLfoShape(int lfo, LfoShape shape);
+        void    setModulation(int slot, ModSource source, ModDestination destination, float amount);
+        void    setControlInterval(int numSamples);
+
+        // Take effect at the next prepare, each voice gets its own seed from it
+        void    setNoiseSeed(juce::uint32 seed)     { _noiseSeed = seed; }
+        void    setNumThreads(int numThreads)       { _numThreads = juce::jlimit(1, maxThreads, numThreads); }
+
+        // Message thread side, the patch with every change made since it was loaded
+        const Patch&    getPatch(void) const        { return _edit.patch; }
+        int             getNumWavetables(void) const { return _edit.wavetables->getNumTables(); }
+
+        int     getNumActiveVoices(void) const      { return _numActive; }
+        bool    isSilent(void) const                { return _outputSilent; }
+        int     getNumThreads(void) const           { return _numThreads; }
+
+    private:
+        // Everything the message thread sets, handed over whole. The curves and
+        // routing at the end are worked out from the rest by publishSettings.
+        struct Settings
+        {
+            Patch                       patch;
+            int                         polyphony           = 16;
+            StealPolicy                 stealPolicy         = StealPolicy::oldest;
+            bool                        retriggerSameNote   = true;
+            int                         oversamplingOrder   = 0;
+            int                         controlInterval     = defaultControlInterval;
+
+            // Counts the patches loaded, a new number means fade over to these settings
+            juce::uint32                patchNumber         = 0;
+
+            // Bank the patch's wavetable is read from, one of _wavetableBanks
+            const WavetableBank*        wavetables          = nullptr;
+
+            double                      processingRate      = 0.0;  // What the envelope curves were made for
+            Envelope::Shape             envelope;
+            UnisonOscillator::Stack     unison;
+            ModulationMatrix            matrix;
+        };
+
+        void    beginBlock(void);
+        bool    renderVoices(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+        void    renderLfos(int numSamples);
+        void    applyFade(int numSamples);
+        int     planJobs(void);
+        void    runJob(int index) override;
+        void    checkForSilence(int numSamples);
+        void    handleMidiEvent(const juce::uint8* data, int numBytes);
+        int     allocateVoice(int midiNoteNumber);
+        int     findVoiceToSteal(void) const;
+        void    removeFinishedVoices(void);
+        void    setProcessingOrder(int order);
+        void    publishSettings(void);
+        juce::Result    findWavetables(const juce::String& path, const WavetableBank*& bank);
+        void    applySettings(const Settings& settings);
+
+        // Voice pool, allocated once and never resized. Only the voices listed in
+        // _activeVoices are rendered, so idle voices are never touched. Bit n of
+        // _usedVoices is set while voice n is on the active list.
+        std::unique_ptr<SynthVoice[]>   _voices;
+        OscillatorBank                  _bank;
+        std::array<int, maxVoices>      _activeVoices;
+        juce::uint64                    _usedVoices;
+        int                             _numActive;
+        juce::uint32                    _voiceCounter;
+
+        // Set once the voices have finished and the output has decayed, cleared by
+        // the next note. While set, rendering only clears the output.
+        bool                            _outputSilent;
+
+        // Brings the oversampled mix down to the device rate. It needs no buffers of
+        // its own, so the factor can be switched from the audio thread.
+        Decimator                       _decimator;
+
+        // Filtering applied to the mix, each voice has its own low pass
+        using StereoFilter = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>;
+        enum
+        {
+            dcBlockerIndex
+        };
+
+        juce::dsp::ProcessorChain<StereoFilter> _outputChain;
+
+        // Scratch buffers, sized in prepare and reused every block
+        juce::AudioBuffer<float>        _mixBuffer;         // One channel per processed channel
+        juce::AudioBuffer<float>        _synthBuffer;       // The mix at the oversampled rate
+        juce::AudioBuffer<float>        _voiceBuffer;       // voiceStride samples per voice
+        juce::AudioBuffer<float>        _jobBuffer;         // Mix for every job after the first
+
+        // Helper threads and the work of the chunk being rendered. Job n renders the
+        // voices in _jobLanes[n] into _jobOutput[n], job 0 straight into the mix.
+        WorkerPool                      _workers;
+        int                             _numThreads;
+        std::array<juce::uint64, maxThreads>                        _jobLanes;
+        std::array<std::array<float*, maxChannels>, maxThreads>     _jobOutput;
+        int                             _jobNumSamples;
+
+        // Shared modulation for the chunk being rendered, the LFO values for each
+        // control step of _stepSize samples, numLfos per step
+        std::array<Lfo, numLfos>        _lfos;
+        ModulationMatrix                _matrix;
+        juce::AudioBuffer<float>        _lfoValues;
+        int                             _stepSize;
+        bool                            _modulated;
+
+        // Shared with the message thread. _edit is the message thread's copy of the
+        // settings, which every setter changes and then publishes.
+        Settings                        _edit;
+
+        // Every bank a patch has used, and the file each was mapped from. The first
+        // is the built in bank, with an empty path. Message thread only.
+        std::vector<std::unique_ptr<WavetableBank>>     _wavetableBanks;
+        juce::StringArray                               _wavetablePaths;
+        TripleBuffer<Settings>          _settings;
+        std::atomic<double>             _sampleRate;
+        juce::uint32                    _noiseSeed;
+
+        // Audio thread copies of the settings. While a new patch waits for the fade
+        // out, the settings in use stay as they were.
+        juce::uint32                    _appliedPatch;
+        bool                            _swapPending;
+        float                           _fadeGain;
+        float                           _fadeStep;          // Per sample at the device rate
+        int                             _polyphony;
+        StealPolicy                     _stealPolicy;
+        bool                            _retriggerSameNote;
+        int                             _controlInterval;
+        int                             _activeOrder;
+        int                             _numChannels;
+
+        JUCE_DECLARE_NON_COPYABLE(SynthEngine)
+    };
+}
+//==============================================================================
@@ -0,0 +1,460 @@
+/*
+  ==============================================================================
+
+    SynthVoice.cpp
+    Created: 19 Oct 2024 2:41:07pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "SynthVoice.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Constructor, the voice starts idle
+    SynthVoice::SynthVoice() :  _wavetable(0.0f, 440.0f, nullptr)
+    {
+        _bank           = nullptr;
+        _lane           = 0;
+        _panLeft        = 1.0f;
+        _panRight       = 1.0f;
+        _sampleRate     = 44100.0;
+        _mainLevel      = 0.0f;
+        _subLevel       = 0.0f;
+        _noiseLevel     = 0.0f;
+        _unisonOn       = false;
+        _stereoUnison   = false;
+        _mainOscillator = MainOscillator::saw;
+        _unisonVoices   = 1;
+        _unisonSpread   = 0.0f;
+        _freq           = 440.0f;
+        _cutoff         = 1000.0f;
+        _pitchMod       = 0.0f;
+        _cutoffMod      = 0.0f;
+        _gain           = 1.0f;
+        _targetGain     = 1.0f;
+        _snapGain       = false;
+        _level          = 0.0f;
+        _note           = -1;
+        _velocity       = 0.0f;
+        _age            = 0;
+        _pendingNote    = -1;
+        _pendingVelocity = 0.0f;
+        _active         = false;
+        _gateOn         = false;
+    }
+
+    // @brief       Function to prepare the voice for playback
+    // @param       sampleRate = The rate the voice is rendered at
+    //              bank = Oscillator bank holding the voice's main and sub oscillators
+    //              lane = The voice's lane in the bank
+    void SynthVoice::prepare(double sampleRate, OscillatorBank& bank, int lane)
+    {
+        _bank = &bank;
+        _lane = lane;
+
+        setSampleRate(sampleRate);
+        kill();
+    }
+
+    // @brief       Function to set the rate the voice is rendered at
+    // @param       sampleRate = The sample rate in Hz
+    void SynthVoice::setSampleRate(double sampleRate)
+    {
+        _sampleRate = sampleRate;
+        _unison.setSampleRate(sampleRate);
+        _wavetable.setSampleRate(sampleRate);
+        _noise.setSampleRate(sampleRate);
+        _filter.setSampleRate(sampleRate);
+        _filterRight.setSampleRate(sampleRate);
+        _envelope.setSampleRate(sampleRate);
+    }
+
+    // @brief       Function to set the oscillator levels
+    // @param       mainLvl = Main oscillator level
+    //              subLvl = Sub oscillator level
+    //              noiseLvl = Noise level
+    void SynthVoice::setLevels(float mainLvl, float subLvl, float noiseLvl)
+    {
+        _mainLevel  = mainLvl;
+        _subLevel   = subLvl;
+        _noiseLevel = noiseLvl;
+
+        // The bank keeps playing the sub when the unison stack or the wavetable takes over the main
+        const bool wavetable = (MainOscillator::wavetable == _mainOscillator);
+        _bank->setLevels(_lane, ((_unisonOn || wavetable) ? 0.0f : mainLvl), subLvl);
+        _unison.setLevel(_unisonOn ? mainLvl : 0.0f);
+        _wavetable.setLevel(wavetable ? mainLvl : 0.0f);
+        _noise.setLevel(noiseLvl);
+    }
+
+    // @brief       Function to set up unison on the main oscillator
+    // @param       stack = Detune and pan of the saws, a single saw turns unison off
+    void SynthVoice::setUnison(const UnisonOscillator::Stack& stack)
+    {
+        _unison.setStack(stack);
+        _unisonVoices   = stack.numOscillators;
+        _unisonSpread   = stack.spread;
+        updateRouting();
+    }
+
+    // @brief       Function to choose what plays the main oscillator
+    // @param       type = Saw or wavetable
+    //              bank = Bank to read for the wavetable, must outlive the voice
+    //              table = Table in the bank
+    void SynthVoice::setMainOscillator(MainOscillator type, const WavetableBank* bank, int table)
+    {
+        _mainOscillator = type;
+        _wavetable.setBank(bank);
+        _wavetable.setTable(table);
+        updateRouting();
+    }
+
+    // @brief       Function to work out which oscillators play from the settings
+    // @param       None
+    void SynthVoice::updateRouting()
+    {
+        const bool wasStereo = _stereoUnison;
+
+        // The unison stack is made of saws, so it only stands in for the saw
+        _unisonOn       = (MainOscillator::saw == _mainOscillator) && (1 < _unisonVoices);
+        _stereoUnison   = _unisonOn && (0.0f < _unisonSpread);
+
+        // The right filter has been idle, clear out whatever it held last time
+        if (_stereoUnison && (! wasStereo))
+        {
+            _filterRight.reset();
+        }
+
+        setLevels(_mainLevel, _subLevel, _noiseLevel);
+    }
+
+    // @brief       Function to select band limited or naive oscillators
+    // @param       bandLimited = True for PolyBLEP saws and mip mapped wavetables
+    void SynthVoice::setBandLimited(bool bandLimited)
+    {
+        _unison.setBandLimited(bandLimited);
+        _wavetable.setBandLimited(bandLimited);
+    }
+
+    // @brief       Function to set the colour of the voice's noise
+    // @param       colour = White, pink or brown
+    void SynthVoice::setNoiseColour(NoiseColour colour)
+    {
+        _noise.setColour(colour);
+    }
+
+    // @brief       Function to restart the voice's noise from a seed
+    // @param       seed = Seed, every voice should get a different one
+    void SynthVoice::setNoiseSeed(juce::uint32 seed)
+    {
+        _noise.setSeed(seed);
+    }
+
+    // @brief       Function to set the low pass cutoff, the filter glides to it
+    // @param       freq = Cutoff frequency in Hz
+    void SynthVoice::setFilterCutoff(float freq)
+    {
+        _cutoff = freq;
+        applyCutoff();
+    }
+
+    // @brief       Function to set the envelope shape
+    // @param       shape = Times and curves, made for the rate the voice runs at
+    void SynthVoice::setEnvelope(const Envelope::Shape& shape)
+    {
+        _envelope.setShape(shape);
+    }
+
+    // @brief       Function to set where the voice sits in the stereo field
+    // @param       pan = -1 for hard left, 0 for centre and 1 for hard right
+    void SynthVoice::setPan(float pan)
+    {
+        pan         = juce::jlimit(-1.0f, 1.0f, pan);
+        _panLeft    = juce::jmin(1.0f, (1.0f - pan));
+        _panRight   = juce::jmin(1.0f, (1.0f + pan));
+    }
+
+    // @brief       Function to start a note on the voice
+    // @param       midiNoteNumber = Note to play
+    //              velocity = Note on velocity
+    //              age = Allocation counter value, used to find the oldest voice
+    void SynthVoice::start(int midiNoteNumber, float velocity, juce::uint32 age)
+    {
+        _freq       = FastMath::noteToFrequency(midiNoteNumber);
+        _snapGain   = true;
+        retune(false);
+
+        // The envelope shapes the attack, a retriggered voice rises from where it is
+        if (! _active)
+        {
+            _filter.reset();
+            _filterRight.reset();
+            _unison.resetPhases(age);
+            _wavetable.resetPhase();
+        }
+        _envelope.noteOn();
+
+        _note           = midiNoteNumber;
+        _pendingNote    = -1;
+        _velocity       = velocity;
+        _age            = age;
+        _active         = true;
+        _gateOn         = true;
+    }
+
+    // @brief       Function to take over a playing voice for a new note. The old note
+    //              fades out quickly and the new one starts from silence when it has.
+    // @param       midiNoteNumber = Note to play
+    //              velocity = Note on velocity
+    //              age = Allocation counter value, used to find the oldest voice
+    void SynthVoice::steal(int midiNoteNumber, float velocity, juce::uint32 age)
+    {
+        if (! _active)
+        {
+            start(midiNoteNumber, velocity, age);
+            return;
+        }
+
+        _envelope.quickRelease();
+
+        // From here on the voice counts as playing the new note
+        _pendingNote        = midiNoteNumber;
+        _pendingVelocity    = velocity;
+        _age                = age;
+        _gateOn             = true;
+    }
+
+    // @brief       Function to release the note, the voice fades out
+    // @param       None
+    void SynthVoice::stop()
+    {
+        _gateOn = false;
+
+        // A note still waiting for the steal to finish is released once it has started
+        if (0 > _pendingNote)
+        {
+            _envelope.noteOff();
+        }
+    }
+
+    // @brief       Function to silence the voice immediately
+    // @param       None
+    void SynthVoice::kill()
+    {
+        _envelope.reset();
+        _filter.reset();
+        _filterRight.reset();
+        _level          = 0.0f;
+        _note           = -1;
+        _pendingNote    = -1;
+        _active         = false;
+        _gateOn         = false;
+    }
+
+    // @brief       Function to work out the voice's modulation for the next control interval
+    // @param       matrix = Routing from the sources to the destinations
+    //              lfoValues = Value of each shared LFO for the interval
+    // @note        The envelope source is its level at the start of the interval
+    void SynthVoice::modulate(const ModulationMatrix& matrix, const float* lfoValues)
+    {
+        float sources[ModulationMatrix::numSources];
+        float destinations[ModulationMatrix::numDestinations];
+
+        sources[static_cast<int>(ModSource::lfo1)]      = lfoValues[0];
+        sources[static_cast<int>(ModSource::lfo2)]      = lfoValues[1];
+        sources[static_cast<int>(ModSource::envelope)]  = _envelope.getLevel();
+        sources[static_cast<int>(ModSource::velocity)]  = _velocity;
+        sources[static_cast<int>(ModSource::note)]      = static_cast<float>(_note - 60) / 60.0f;
+
+        matrix.process(sources, destinations);
+
+        // Retuning and moving the cutoff both do some maths, so only when they change.
+        // The pitch glides over the interval, except on a fresh note.
+        const float pitchMod = destinations[static_cast<int>(ModDestination::pitch)] * ModulationMatrix::pitchRange;
+        if (pitchMod != _pitchMod)
+        {
+            _pitchMod = pitchMod;
+            retune(! _snapGain);
+        }
+
+        const float cutoffMod = destinations[static_cast<int>(ModDestination::filterCutoff)] * ModulationMatrix::cutoffRange;
+        if (cutoffMod != _cutoffMod)
+        {
+            _cutoffMod = cutoffMod;
+            applyCutoff();
+        }
+
+        _targetGain = juce::jlimit(0.0f, 2.0f, (1.0f + destinations[static_cast<int>(ModDestination::level)]));
+        if (_snapGain)
+        {
+            _gain       = _targetGain;
+            _snapGain   = false;
+        }
+    }
+
+    // @brief       Function to drop any modulation, used when the matrix is switched off
+    // @param       None
+    void SynthVoice::clearModulation()
+    {
+        if (0.0f != _pitchMod)
+        {
+            _pitchMod = 0.0f;
+            retune(true);
+        }
+
+        if (0.0f != _cutoffMod)
+        {
+            _cutoffMod = 0.0f;
+            applyCutoff();
+        }
+
+        _targetGain = 1.0f;
+        _snapGain   = false;
+    }
+
+    // @brief       Function to set the oscillator frequencies from the note and the pitch modulation
+    // @param       glide = True to ramp the phase increments over the next render, as the
+    //                      level is, false to jump to the new pitch
+    void SynthVoice::retune(bool glide)
+    {
+        const float freq = (0.0f == _pitchMod) ? _freq : (_freq * FastMath::semitonesToRatio(_pitchMod));
+        if (glide)
+        {
+            _bank->glideFrequency(_lane, freq, (freq / 2.0f));
+            _unison.glideFrequency(freq);
+            _wavetable.glideFrequency(freq);
+        }
+        else
+        {
+            _bank->setFrequency(_lane, freq, (freq / 2.0f));
+            _unison.setFrequency(freq);
+            _wavetable.setFrequency(freq);
+        }
+    }
+
+    // @brief       Function to set the filter target from the cutoff and its modulation
+    // @param       None
+    void SynthVoice::applyCutoff()
+    {
+        const float freq = (0.0f == _cutoffMod) ? _cutoff : (_cutoff * FastMath::exp2(_cutoffMod));
+        _filter.setCutoff(freq);
+        _filterRight.setCutoff(freq);
+    }
+
+    // @brief       Function to apply the level modulation to a buffer
+    // @param       data = Samples to scale in place
+    //              numSamples = Number of samples
+    //              startGain = Gain at the first sample, ramped to _targetGain by the end
+    void SynthVoice::applyGain(float* data, int numSamples, float startGain) const
+    {
+        if (startGain == _targetGain)
+        {
+            juce::FloatVectorOperations::multiply(data, _targetGain, numSamples);
+            return;
+        }
+
+        const float step = (_targetGain - startGain) / static_cast<float>(numSamples);
+        float gain = startGain;
+        for (int sample = 0; sample < numSamples; sample++)
+        {
+            gain            += step;
+            data[sample]    *= gain;
+        }
+    }
+
+    // @brief       Function for rendering the voice
+    // @param       left = Left (or mono) buffer the voice output is added to
+    //              right = Right buffer the voice output is added to, nullptr for mono
+    //              osc = The voice's lane of the oscillator bank output, used as
+    //                    the work buffer for the rest of the voice
+    //              oscRight = Work buffer for the right channel of stereo unison
+    //              numSamples = Number of samples to render
+    void SynthVoice::render(float* left, float* right, float* osc, float* oscRight, int numSamples)
+    {
+        if (! _active)
+        {
+            return;
+        }
+
+        // Only a spread unison stack needs its own right channel
+        const bool stereo = _stereoUnison && (nullptr != right);
+
+        _noise.renderBlock(osc, numSamples);
+        if (MainOscillator::wavetable == _mainOscillator)
+        {
+            _wavetable.renderBlock(osc, numSamples);
+        }
+        else if (_unisonOn)
+        {
+            if (stereo)
+            {
+                juce::FloatVectorOperations::copy(oscRight, osc, numSamples);
+            }
+            _unison.render(osc, (stereo ? oscRight : nullptr), numSamples);
+        }
+
+        _filter.process(osc, numSamples);
+        if (stereo)
+        {
+            _filterRight.process(oscRight, numSamples);
+        }
+        _envelope.process(osc, (stereo ? oscRight : nullptr), numSamples);
+
+        // Unmodulated voices skip the gain altogether, a changing one is ramped per sample
+        if ((1.0f != _gain) || (1.0f != _targetGain))
+        {
+            applyGain(osc, numSamples, _gain);
+            if (stereo)
+            {
+                applyGain(oscRight, numSamples, _gain);
+            }
+            _gain = _targetGain;
+        }
+
+        if (nullptr == right)
+        {
+            juce::FloatVectorOperations::add(left, osc, numSamples);
+        }
+        else
+        {
+            juce::FloatVectorOperations::addWithMultiply(left, osc, _panLeft, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(right, (stereo ? oscRight : osc), _panRight, numSamples);
+        }
+
+        auto range  = juce::FloatVectorOperations::findMinAndMax(osc, numSamples);
+        _level      = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+        if (stereo)
+        {
+            range   = juce::FloatVectorOperations::findMinAndMax(oscRight, numSamples);
+            _level  = juce::jmax(_level, std::abs(range.getStart()), std::abs(range.getEnd()));
+        }
+
+        if (! _envelope.isActive())
+        {
+            if (0 <= _pendingNote)
+            {
+                // The stolen note has faded out, start the new one from silence
+                const bool gateOn   = _gateOn;
+                const int note      = _pendingNote;
+                _pendingNote        = -1;
+                _active             = false;
+
+                start(note, _pendingVelocity, _age);
+                if (! gateOn)
+                {
+                    stop();
+                }
+            }
+            else
+            {
+                // Silent from here on, free the voice so it is no longer rendered
+                kill();
+            }
+        }
+    }
+}
+//==============================================================================
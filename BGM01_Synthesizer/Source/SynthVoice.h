@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    SynthVoice.h
+    Created: 19 Oct 2024 2:41:07pm
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Synthesizer.h"
+#include "OscillatorBank.h"
+#include "UnisonOscillator.h"
+#include "StateVariableFilter.h"
+#include "NoiseGenerator.h"
+#include "Envelope.h"
+#include "ModulationMatrix.h"
+#include "FastMath.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // What plays the main oscillator of a voice
+    enum class MainOscillator
+    {
+        saw,            // PolyBLEP saw in the oscillator bank, or a unison stack of them
+        wavetable       // One table of a wavetable bank, band limited by its mip levels
+    };
+
+    // A single voice of the synth, i.e. the main, sub and noise oscillators
+    // through a low pass filter and an ADSR envelope driven by note on/off. The
+    // main and sub oscillators live in the shared OscillatorBank at the voice's
+    // lane. In unison mode the main oscillator is replaced by a stack of detuned
+    // saws, and with stereo spread the rest of the voice runs on two channels.
+    // With the wavetable main oscillator the voice reads a table of a shared
+    // bank instead, and the unison stack is not used.
+    // Modulation is applied at control rate: the engine calls modulate once per
+    // control interval, pitch and cutoff are updated there (the filter glides to
+    // the new cutoff), and a changing pitch or level is ramped per sample over
+    // the interval in render.
+    // The voice frees itself once its envelope has gone idle. A stolen voice
+    // fades out over a few milliseconds before it starts its new note.
+    class SynthVoice
+    {
+    public:
+        SynthVoice();
+        ~SynthVoice()
+        {
+
+        }
+
+        void    prepare(double sampleRate, OscillatorBank& bank, int lane);
+        void    setSampleRate(double sampleRate);
+        void    setLevels(float mainLvl, float subLvl, float noiseLvl);
+        void    setUnison(const UnisonOscillator::Stack& stack);
+        void    setMainOscillator(MainOscillator type, const WavetableBank* bank, int table);
+        void    setBandLimited(bool bandLimited);
+        void    setNoiseColour(NoiseColour colour);
+        void    setNoiseSeed(juce::uint32 seed);
+        void    setFilterCutoff(float freq);
+        void    setEnvelope(const Envelope::Shape& shape);
+        void    setPan(float pan);
+
+        void    start(int midiNoteNumber, float velocity, juce::uint32 age);
+        void    steal(int midiNoteNumber, float velocity, juce::uint32 age);
+        void    stop(void);
+        void    kill(void);
+
+        void    modulate(const ModulationMatrix& matrix, const float* lfoValues);
+        void    clearModulation(void);
+
+        void    render(float* left, float* right, float* osc, float* oscRight, int numSamples);
+
+        bool            isActive(void) const        { return _active; }
+        bool            isGateOn(void) const        { return _gateOn; }
+        int             getNote(void) const         { return (0 <= _pendingNote) ? _pendingNote : _note; }
+        int             getLane(void) const         { return _lane; }
+        juce::uint32    getAge(void) const          { return _age; }
+        float           getLevel(void) const        { return _level; }
+
+    private:
+        void    retune(bool glide);
+        void    updateRouting(void);
+        void    applyCutoff(void);
+        void    applyGain(float* data, int numSamples, float startGain) const;
+
+        OscillatorBank* _bank;
+        int             _lane;
+        NoiseGenerator  _noise;
+        UnisonOscillator                _unison;
+        WavetableSynth                  _wavetable;
+
+        StateVariableFilter             _filter;
+        StateVariableFilter             _filterRight;       // Only used for stereo unison
+        Envelope                        _envelope;
+
+        // Channel gains, both are 1 when centred so mono and stereo play at the same level
+        float           _panLeft;
+        float           _panRight;
+
+        double          _sampleRate;
+
+        // Main level, given to the bank or the unison stack, whichever is playing
+        float           _mainLevel;
+        float           _subLevel;
+        float           _noiseLevel;
+        bool            _unisonOn;
+        bool            _stereoUnison;
+
+        // What was asked for, the routing above follows from these
+        MainOscillator  _mainOscillator;
+        int             _unisonVoices;
+        float           _unisonSpread;
+
+        // Unmodulated note frequency and cutoff, and the modulation applied to them
+        // in semitones and octaves
+        float           _freq;
+        float           _cutoff;
+        float           _pitchMod;
+        float           _cutoffMod;
+
+        // Level modulation, ramped from _gain to _targetGain over the next render.
+        // A fresh note jumps straight to its first target, and to its first pitch.
+        float           _gain;
+        float           _targetGain;
+        bool            _snapGain;
+
+        // Peak output level of the last block, used when stealing the quietest voice
+        float           _level;
+
+        int             _note;
+        float           _velocity;
+        juce::uint32    _age;
+
+        // Note to start once a stolen voice has faded out, -1 for none
+        int             _pendingNote;
+        float           _pendingVelocity;
+        bool            _active;
+        bool            _gateOn;
+
+        JUCE_DECLARE_NON_COPYABLE(SynthVoice)
+    };
+}
+//==============================================================================
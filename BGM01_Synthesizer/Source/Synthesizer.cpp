@@ -15,14 +15,47 @@
 // BGM01 Namespace for synthesizer
 namespace BGM01
 {
+    // @brief       Wavetable value at a phase, linearly interpolated
+    // @param       samples = One mip level, tableSize + 1 samples
+    //              tableSize = Samples per cycle
+    //              phase = Phase in [0, 1)
+    static inline float tableWave(const float* samples, float tableSize, float phase)
+    {
+        const float position    = phase * tableSize;
+        const int index         = static_cast<int>(position);
+        const float frac        = position - static_cast<float>(index);
+
+        // The extra sample at the end saves wrapping index + 1
+        return samples[index] + frac * (samples[index + 1] - samples[index]);
+    }
+
     // @brief       Function for sampling the waveform
-    // @param       t = Sample time
-    float SynthesizerBase::sample(float t)
+    // @param       None
+    float SynthesizerBase::sample()
     {
         // The base class is just a DC source
         return 0.0f;
     }
 
+    // @brief       Function for rendering a block of the waveform
+    // @param       out = Buffer the waveform is added to
+    //              numSamples = Number of samples to render
+    void SynthesizerBase::renderBlock(float* out, int numSamples)
+    {
+        // The base class is just a DC source, so there is nothing to add
+    }
+
+    // @brief       Function to set the sample rate the waveform is rendered at
+    // @param       sampleRate = The sample rate in Hz
+    void SynthesizerBase::setSampleRate(double sampleRate)
+    {
+        if (0.0 < sampleRate)
+        {
+            _sampleTime = static_cast<float>(1.0 / sampleRate);
+            updateIncrement();
+        }
+    }
+
     // @brief       Function to set the waveform frequency
     // @param       freq = The frequency to set to
     void SynthesizerBase::setFrequency(float freq)
@@ -31,6 +64,19 @@ namespace BGM01
         if ((10.0f <= freq) && (20000.0f >= freq))
         {
             _frequency = freq;
+            updateIncrement();
+        }
+    }
+
+    // @brief       Function to move to a new frequency over the next block, the phase
+    //              increment ramps linearly so the pitch doesn't step
+    // @param       freq = The frequency to glide to
+    void SynthesizerBase::glideFrequency(float freq)
+    {
+        if ((10.0f <= freq) && (20000.0f >= freq))
+        {
+            _frequency          = freq;
+            _targetIncrement    = _frequency * _sampleTime;
         }
     }
 
@@ -60,9 +106,51 @@ namespace BGM01
         }
     }
 
+    // @brief       Function to restart the waveform from the beginning of its cycle
+    // @param       None
+    void SynthesizerBase::resetPhase()
+    {
+        _phase = 0.0f;
+    }
+
+    // @brief       Function to select the band limited (PolyBLEP) or naive waveform
+    // @param       bandLimited = True to suppress aliasing at the discontinuities
+    void SynthesizerBase::setBandLimited(bool bandLimited)
+    {
+        _bandLimited = bandLimited;
+    }
+
+    // @brief       Function to recalculate the per sample phase increment
+    // @param       None
+    // @note        Only called when the frequency or sample rate changes, which keeps
+    //              the division out of the per sample path
+    void SynthesizerBase::updateIncrement()
+    {
+        _phaseIncrement     = _frequency * _sampleTime;
+        _invIncrement       = (0.0f < _phaseIncrement) ? (1.0f / _phaseIncrement) : 0.0f;
+        _targetIncrement    = _phaseIncrement;
+    }
+
+    // @brief       Function to move the phase on without producing output
+    // @param       numSamples = Number of samples to skip
+    void SynthesizerBase::advancePhase(int numSamples)
+    {
+        // A glide's increment grows by a step before every sample
+        const float span = static_cast<float>(numSamples);
+        const float step = (_targetIncrement - _phaseIncrement) / span;
+
+        _phase += (_phaseIncrement * span) + (((span * (span + 1.0f)) / 2.0f) * step);
+        _phase -= std::floor(_phase);
+
+        if (_targetIncrement != _phaseIncrement)
+        {
+            updateIncrement();
+        }
+    }
+
     // @brief       Function override of sample for noise synth
-    // @param       t = Sample time
-    float NoiseSynth::sample(float t)
+    // @param       None
+    float NoiseSynth::sample()
     {
         float lvlScale = 0.0f;
 
@@ -78,47 +166,253 @@ namespace BGM01
         }
     }
 
-    // @brief       Function override of sample for sawtooth synth
-    // @param       t = Sample time
-    float SawtoothSynth::sample(float t)
+    // @brief       Function override of renderBlock for noise synth
+    // @param       out = Buffer the noise is added to
+    //              numSamples = Number of samples to render
+    void NoiseSynth::renderBlock(float* out, int numSamples)
     {
-        float period       = (1.0f / _frequency);
-        float sample_mod   = fmod(t, period);
-        if (0.0f < _targetLevel)
+        if (0.0f >= _targetLevel)
+        {
+            return;
+        }
+
+        int sample = 0;
+
+        // Ramp the level up first, then the level is constant for the rest of the block
+        for (; (sample < numSamples) && (_currentLevel != _targetLevel); sample++)
         {
             incrementLevel();
-            return _currentLevel * ((sample_mod * _frequency) * 2.0f - 1.0f);
+            out[sample] += _random.nextFloat() * (_currentLevel * 2.0f) - _currentLevel;
         }
-        else
+
+        const float lvl      = _currentLevel;
+        const float lvlScale = lvl * 2.0f;
+        for (; sample < numSamples; sample++)
         {
-            return 0.0f;
+            out[sample] += _random.nextFloat() * lvlScale - lvl;
         }
     }
 
-    // @brief       Function override of sample for square wave synth
-    // @param       t = Sample time
-    float SquareSynth::sample(float t)
+    // @brief       Function override of sample for the waveform synths
+    // @param       None
+    template <typename Wave>
+    float WaveSynth<Wave>::sample()
     {
-        float period = (1.0f / _frequency);
-        float half_period = (period / 2.0f);
-        float time = fmod(t, period);
+        // One sample at a time there is nothing to ramp over, so a glide jumps
+        if (_targetIncrement != _phaseIncrement)
+        {
+            updateIncrement();
+        }
+
+        float phase = _phase;
+
+        _phase += _phaseIncrement;
+        _phase -= (1.0f <= _phase) ? 1.0f : 0.0f;
 
         if (0.0f < _targetLevel)
         {
             incrementLevel();
-            if (time < half_period)
-            {
-                return (1.0f * _currentLevel);
-            }
-            else
+            if (_bandLimited)
             {
-                return (-1.0f * _currentLevel);
+                return _currentLevel * Wave::template value<true>(phase, _phaseIncrement, _invIncrement);
             }
+            return _currentLevel * Wave::template value<false>(phase, _phaseIncrement, _invIncrement);
+        }
+        else
+        {
+            return 0.0f;
+        }
+    }
+
+    // @brief       Function override of renderBlock for the waveform synths
+    // @param       out = Buffer the waveform is added to
+    //              numSamples = Number of samples to render
+    // @note        The phase carries over between blocks so there is no reset at the
+    //              block boundary
+    template <typename Wave>
+    void WaveSynth<Wave>::renderBlock(float* out, int numSamples)
+    {
+        if (0.0f >= _targetLevel)
+        {
+            // Keep the oscillator running so it stays in phase while silent
+            advancePhase(numSamples);
+        }
+        else if (_bandLimited)
+        {
+            render<true>(out, numSamples);
+        }
+        else
+        {
+            render<false>(out, numSamples);
+        }
+    }
+
+    // @brief       Function for rendering the waveform with the band limiting fixed
+    // @param       out = Buffer the waveform is added to
+    //              numSamples = Number of samples to render
+    template <typename Wave>
+    template <bool BandLimited>
+    void WaveSynth<Wave>::render(float* out, int numSamples)
+    {
+        const bool gliding = (_targetIncrement != _phaseIncrement);
+
+        // A glide steps 1 / inc evenly as well, which is close enough over one block
+        float       inc         = _phaseIncrement;
+        float       invInc      = _invIncrement;
+        const float incStep     = gliding ? ((_targetIncrement - inc) / static_cast<float>(numSamples)) : 0.0f;
+        const float invIncStep  = gliding ? (((1.0f / _targetIncrement) - invInc) / static_cast<float>(numSamples)) : 0.0f;
+        float       phase       = _phase;
+        int sample = 0;
+
+        for (; (sample < numSamples) && (_currentLevel != _targetLevel); sample++)
+        {
+            incrementLevel();
+            inc         += incStep;
+            invInc      += invIncStep;
+            out[sample] += _currentLevel * Wave::template value<BandLimited>(phase, inc, invInc);
+            phase       += inc;
+            phase       -= (1.0f <= phase) ? 1.0f : 0.0f;
+        }
+
+        // Loop without the level ramp once the level has settled
+        const float lvl = _currentLevel;
+        for (; sample < numSamples; sample++)
+        {
+            inc         += incStep;
+            invInc      += invIncStep;
+            out[sample] += lvl * Wave::template value<BandLimited>(phase, inc, invInc);
+            phase       += inc;
+            phase       -= (1.0f <= phase) ? 1.0f : 0.0f;
+        }
+
+        _phase = phase;
+        if (gliding)
+        {
+            updateIncrement();
+        }
+    }
+
+    // The waveforms there are synths for
+    template class WaveSynth<Kernels::Saw>;
+    template class WaveSynth<Kernels::Square>;
+
+    // @brief       Function to set the bank the tables are read from
+    // @param       bank = The bank, shared between synths and not owned
+    void WavetableSynth::setBank(const WavetableBank* bank)
+    {
+        _bank = bank;
+        updateTable();
+    }
+
+    // @brief       Function to choose the table in the bank
+    // @param       table = Table index, limited to the tables in the bank
+    void WavetableSynth::setTable(int table)
+    {
+        _table = juce::jmax(0, table);
+        updateTable();
+    }
+
+    // @brief       Function to pick the table and mip level for the current pitch
+    // @param       None
+    // @note        Called again whenever the increment or band limiting has changed
+    //              since, which costs one compare per block
+    void WavetableSynth::updateTable()
+    {
+        _tableIncrement     = getTableIncrement();
+        _tableBandLimited   = _bandLimited;
+
+        if ((nullptr == _bank) || (! _bank->isLoaded()))
+        {
+            _samples    = nullptr;
+            _tableSize  = 0.0f;
+            return;
+        }
+
+        // Without band limiting the full table is read at every pitch and aliases
+        const int table     = juce::jmin(_table, (_bank->getNumTables() - 1));
+        const int level     = _bandLimited ? _bank->getLevelForIncrement(_tableIncrement) : 0;
+        _samples            = _bank->getTable(table, level);
+        _tableSize          = static_cast<float>(_bank->getTableSize());
+    }
+
+    // @brief       Function override of sample for wavetable synth
+    // @param       None
+    float WavetableSynth::sample()
+    {
+        // One sample at a time there is nothing to ramp over, so a glide jumps
+        if (_targetIncrement != _phaseIncrement)
+        {
+            updateIncrement();
+        }
+
+        if ((_tableIncrement != getTableIncrement()) || (_tableBandLimited != _bandLimited))
+        {
+            updateTable();
+        }
+
+        float phase = _phase;
+
+        _phase += _phaseIncrement;
+        _phase -= (1.0f <= _phase) ? 1.0f : 0.0f;
+
+        if ((0.0f < _targetLevel) && (nullptr != _samples))
+        {
+            incrementLevel();
+            return _currentLevel * tableWave(_samples, _tableSize, phase);
         }
         else
         {
             return 0.0f;
         }
     }
+
+    // @brief       Function override of renderBlock for wavetable synth
+    // @param       out = Buffer the waveform is added to
+    //              numSamples = Number of samples to render
+    void WavetableSynth::renderBlock(float* out, int numSamples)
+    {
+        if ((_tableIncrement != getTableIncrement()) || (_tableBandLimited != _bandLimited))
+        {
+            updateTable();
+        }
+
+        if ((0.0f >= _targetLevel) || (nullptr == _samples))
+        {
+            advancePhase(numSamples);
+            return;
+        }
+
+        const bool gliding      = (_targetIncrement != _phaseIncrement);
+        const float* samples    = _samples;
+        const float tableSize   = _tableSize;
+        float       inc         = _phaseIncrement;
+        const float incStep     = gliding ? ((_targetIncrement - inc) / static_cast<float>(numSamples)) : 0.0f;
+        float       phase       = _phase;
+        int sample = 0;
+
+        for (; (sample < numSamples) && (_currentLevel != _targetLevel); sample++)
+        {
+            incrementLevel();
+            inc         += incStep;
+            out[sample] += _currentLevel * tableWave(samples, tableSize, phase);
+            phase       += inc;
+            phase       -= (1.0f <= phase) ? 1.0f : 0.0f;
+        }
+
+        const float lvl = _currentLevel;
+        for (; sample < numSamples; sample++)
+        {
+            inc         += incStep;
+            out[sample] += lvl * tableWave(samples, tableSize, phase);
+            phase       += inc;
+            phase       -= (1.0f <= phase) ? 1.0f : 0.0f;
+        }
+
+        _phase = phase;
+        if (gliding)
+        {
+            updateIncrement();
+        }
+    }
 }
 //==============================================================================
\ No newline at end of file
@@ -11,6 +11,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "OscillatorKernels.h"
+#include "WavetableBank.h"
 
 //==============================================================================
 // BGM01 Namespace for synthesizer
@@ -23,20 +25,41 @@ namespace BGM01
         SynthesizerBase(float lvl, float freq) : _targetLevel(lvl), _frequency(freq)
         {
             _currentLevel = lvl;
+            updateIncrement();
         };
-        ~SynthesizerBase()
+        virtual ~SynthesizerBase()
         {
 
         };
 
-        virtual float  sample(float t);
+        virtual float  sample(void);
+        virtual void   renderBlock(float* out, int numSamples);
+        void    setSampleRate(double sampleRate);
         void    setFrequency(float freq);
+        void    glideFrequency(float freq);
         void    setLevel(float lvl);
         void    incrementLevel(void);
+        void    resetPhase(void);
+        void    setBandLimited(bool bandLimited);
     protected:
+        void    updateIncrement(void);
+        void    advancePhase(int numSamples);
+
         float  _targetLevel;
         float  _currentLevel;
         float  _frequency;
+        float  _sampleTime      = (1.0f / 44100.0f);
+
+        // Normalized phase in [0, 1) and the amount it moves per sample
+        float  _phase           = 0.0f;
+        float  _phaseIncrement  = 0.0f;
+        float  _invIncrement    = 0.0f;
+
+        // Increment a glide ramps to over the next block, the same as _phaseIncrement otherwise
+        float  _targetIncrement = 0.0f;
+
+        // Apply PolyBLEP correction to the discontinuities of the waveform
+        bool   _bandLimited     = true;
     };
 
     // Noise synthesizer
@@ -52,45 +75,72 @@ namespace BGM01
 
         }
 
-        float  sample(float t) override;
+        float  sample(void) override;
+        void   renderBlock(float* out, int numSamples) override;
     private:
         juce::Random    _random;
     };
 
-    // Sawtooth synthesizer
-    class SawtoothSynth : public SynthesizerBase
+    // Synthesizer for one of the waveform policies in OscillatorKernels.h. The
+    // waveform is a template parameter, so the per sample maths is inlined into
+    // the render loops, and the class is final so calls on a concrete synth
+    // don't go through the virtual functions.
+    template <typename Wave>
+    class WaveSynth final : public SynthesizerBase
     {
     public:
-        SawtoothSynth(float lvl, float freq) : SynthesizerBase(lvl, freq)
+        WaveSynth(float lvl, float freq) : SynthesizerBase(lvl, freq)
         {
 
         }
-        ~SawtoothSynth()
+        ~WaveSynth()
         {
 
         }
 
-        float  sample(float t) override;
+        float  sample(void) override;
+        void   renderBlock(float* out, int numSamples) override;
     private:
-
+        template <bool BandLimited>
+        void   render(float* out, int numSamples);
     };
 
+    // Sawtooth synthesizer
+    using SawtoothSynth = WaveSynth<Kernels::Saw>;
+
     // Square wave synth
-    class SquareSynth : public SynthesizerBase
+    using SquareSynth   = WaveSynth<Kernels::Square>;
+
+    // Wavetable synth, reads one table of a shared bank and picks the mip level
+    // from the pitch, so any shape stays band limited without PolyBLEP
+    class WavetableSynth : public SynthesizerBase
     {
     public:
-        SquareSynth(float lvl, float freq) : SynthesizerBase(lvl, freq)
+        WavetableSynth(float lvl, float freq, const WavetableBank* bank) : SynthesizerBase(lvl, freq)
         {
-
+            setBank(bank);
         }
-        ~SquareSynth()
+        ~WavetableSynth()
         {
 
         }
 
-        float sample(float t) override;
+        float sample(void) override;
+        void  renderBlock(float* out, int numSamples) override;
+        void  setBank(const WavetableBank* bank);
+        void  setTable(int table);
     private:
+        void  updateTable(void);
+
+        // Mip levels are picked for the higher end of a glide, so it can't alias
+        float getTableIncrement(void) const     { return juce::jmax(_phaseIncrement, _targetIncrement); }
 
+        const WavetableBank*    _bank               = nullptr;  // Not owned, must outlive the synth
+        const float*            _samples            = nullptr;  // Mip level being played
+        float                   _tableSize          = 0.0f;
+        float                   _tableIncrement     = -1.0f;    // Increment the level was picked for
+        bool                    _tableBandLimited   = true;
+        int                     _table              = 0;
     };
 }
 //==============================================================================
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 2 Nov 2024 9:47:21am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Wait-free single producer, single consumer exchange of whole values. The
+    // producer fills the write slot and publishes it, the consumer picks up the
+    // most recently published slot. Neither side ever sees a half written value
+    // and neither side ever blocks.
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer()
+        {
+
+        }
+        ~TripleBuffer()
+        {
+
+        }
+
+        // @brief       Producer: slot to fill before calling publish
+        // @param       None
+        T& getWriteBuffer(void)
+        {
+            return _buffers[_writeIndex];
+        }
+
+        // @brief       Producer: hand the write slot over to the consumer
+        // @param       None
+        void publish(void)
+        {
+            const int previous = _middle.exchange((_writeIndex | dirtyBit), std::memory_order_acq_rel);
+            _writeIndex = (previous & indexMask);
+        }
+
+        // @brief       Producer: copy a value in and publish it
+        // @param       value = The value to publish
+        void write(const T& value)
+        {
+            getWriteBuffer() = value;
+            publish();
+        }
+
+        // @brief       Consumer: swap in the latest published value if there is one
+        // @param       None
+        // @return      True if the read slot changed
+        bool update(void)
+        {
+            if (0 == (_middle.load(std::memory_order_relaxed) & dirtyBit))
+            {
+                return false;
+            }
+
+            const int previous = _middle.exchange(_readIndex, std::memory_order_acq_rel);
+            _readIndex = (previous & indexMask);
+            return true;
+        }
+
+        // @brief       Consumer: the value picked up by the last update
+        // @param       None
+        const T& getReadBuffer(void) const
+        {
+            return _buffers[_readIndex];
+        }
+
+    private:
+        static constexpr int dirtyBit   = 4;
+        static constexpr int indexMask  = 3;
+
+        std::array<T, 3>    _buffers    {};
+        int                 _writeIndex = 0;
+        std::atomic<int>    _middle     { 1 };
+        int                 _readIndex  = 2;
+
+        JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+    };
+}
+//==============================================================================
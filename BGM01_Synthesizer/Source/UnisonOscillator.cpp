@@ -0,0 +1,352 @@
+/*
+  ==============================================================================
+
+    UnisonOscillator.cpp
+    Created: 21 Dec 2024 10:26:14am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "UnisonOscillator.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    using namespace PolyBlep;
+    using namespace Kernels;
+
+    // @brief       Constructor, a single centred oscillator at 440Hz
+    UnisonOscillator::UnisonOscillator()
+    {
+        _freq           = 440.0f;
+        _sampleTime     = (1.0f / 44100.0f);
+        _level          = 0.0f;
+        _targetLevel    = 0.0f;
+        _numOscillators = 1;
+        _bandLimited    = true;
+        _gliding        = false;
+
+        for (int osc = 0; osc < maxOscillators; osc++)
+        {
+            _phase[osc] = 0.0f;
+        }
+
+        setUnison(1, 0.0f, 0.0f);
+    }
+
+    // @brief       Function to set the sample rate the oscillators run at
+    // @param       sampleRate = The sample rate in Hz
+    void UnisonOscillator::setSampleRate(double sampleRate)
+    {
+        if (0.0 < sampleRate)
+        {
+            _sampleTime = static_cast<float>(1.0 / sampleRate);
+            updateIncrements(false);
+        }
+    }
+
+    // @brief       Function to select the band limited (PolyBLEP) or naive saws
+    // @param       bandLimited = True to suppress aliasing at the discontinuities
+    void UnisonOscillator::setBandLimited(bool bandLimited)
+    {
+        _bandLimited = bandLimited;
+    }
+
+    // @brief       Function to set the frequency the stack is centred on
+    // @param       freq = Frequency in Hz
+    void UnisonOscillator::setFrequency(float freq)
+    {
+        _freq = juce::jlimit(10.0f, 20000.0f, freq);
+        updateIncrements(false);
+    }
+
+    // @brief       Function to move the frequency over the next render, the phase
+    //              increments ramp linearly so the pitch doesn't step
+    // @param       freq = Frequency in Hz
+    void UnisonOscillator::glideFrequency(float freq)
+    {
+        _freq = juce::jlimit(10.0f, 20000.0f, freq);
+        updateIncrements(true);
+    }
+
+    // @brief       Function to set the size and shape of the stack
+    // @param       numOscillators = Number of detuned saws, 1 to maxOscillators
+    //              detuneCents = Detune of the outermost saws from the note, in cents
+    //              spread = Stereo width, 0 is mono and 1 pans the outermost saws hard
+    void UnisonOscillator::setUnison(int numOscillators, float detuneCents, float spread)
+    {
+        setStack(makeStack(numOscillators, detuneCents, spread));
+    }
+
+    // @brief       Function to take on a stack made by makeStack
+    // @param       stack = Detune ratios and gains
+    void UnisonOscillator::setStack(const Stack& stack)
+    {
+        _numOscillators = stack.numOscillators;
+
+        for (int osc = 0; osc < maxOscillators; osc++)
+        {
+            _ratio[osc]     = stack.ratio[osc];
+            _gainLeft[osc]  = stack.gainLeft[osc];
+            _gainRight[osc] = stack.gainRight[osc];
+            _gainMono[osc]  = stack.gainMono[osc];
+        }
+
+        updateIncrements(false);
+    }
+
+    // @brief       Function to work out the detune ratios and gains of a stack
+    // @param       numOscillators = Number of detuned saws, 1 to maxOscillators
+    //              detuneCents = Detune of the outermost saws from the note, in cents
+    //              spread = Stereo width, 0 is mono and 1 pans the outermost saws hard
+    // @return      The stack, for setStack
+    UnisonOscillator::Stack UnisonOscillator::makeStack(int numOscillators, float detuneCents, float spread)
+    {
+        Stack stack;
+        stack.numOscillators    = juce::jlimit(1, maxOscillators, numOscillators);
+        stack.spread            = juce::jlimit(0.0f, 1.0f, spread);
+        detuneCents             = juce::jlimit(0.0f, 100.0f, detuneCents);
+
+        const float gain        = 1.0f / std::sqrt(static_cast<float>(stack.numOscillators));
+
+        for (int osc = 0; osc < maxOscillators; osc++)
+        {
+            if (osc >= stack.numOscillators)
+            {
+                stack.ratio[osc]        = 1.0f;
+                stack.gainLeft[osc]     = 0.0f;
+                stack.gainRight[osc]    = 0.0f;
+                stack.gainMono[osc]     = 0.0f;
+                continue;
+            }
+
+            // Position in the stack from -1 to 1
+            const float position = (1 < stack.numOscillators) ? (((2.0f * osc) / (stack.numOscillators - 1)) - 1.0f) : 0.0f;
+            const float pan      = position * stack.spread;
+
+            stack.ratio[osc]        = std::exp2((position * detuneCents) / 1200.0f);
+            stack.gainLeft[osc]     = gain * juce::jmin(1.0f, (1.0f - pan));
+            stack.gainRight[osc]    = gain * juce::jmin(1.0f, (1.0f + pan));
+            stack.gainMono[osc]     = gain;
+        }
+
+        return stack;
+    }
+
+    // @brief       Function to set the target level, the level ramps up to it
+    // @param       lvl = The level
+    void UnisonOscillator::setLevel(float lvl)
+    {
+        _targetLevel = juce::jlimit(0.0f, 1.0f, lvl);
+    }
+
+    // @brief       Function to scatter the oscillator phases, so a new note doesn't
+    //              start with every saw lined up
+    // @param       seed = Seed, the same seed gives the same phases
+    void UnisonOscillator::resetPhases(juce::uint32 seed)
+    {
+        juce::uint32 state = (seed * 0x9e3779b9u) | 1u;
+
+        for (int osc = 0; osc < maxOscillators; osc++)
+        {
+            state      ^= state << 13;
+            state      ^= state >> 17;
+            state      ^= state << 5;
+            _phase[osc] = static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+
+    // @brief       Function for rendering the stack, adds to the buffers
+    // @param       left = Left (or mono) buffer
+    //              right = Right buffer, nullptr to render mono
+    //              numSamples = Number of samples to render
+    void UnisonOscillator::render(float* left, float* right, int numSamples)
+    {
+       #if BGM01_USE_SIMD
+        if (_bandLimited)
+        {
+            renderSimd<true>(left, right, numSamples);
+        }
+        else
+        {
+            renderSimd<false>(left, right, numSamples);
+        }
+       #else
+        if (_bandLimited)
+        {
+            renderScalar<true>(left, right, numSamples);
+        }
+        else
+        {
+            renderScalar<false>(left, right, numSamples);
+        }
+       #endif
+    }
+
+    // @brief       Scalar fallback kernel, one oscillator at a time
+    // @param       See render
+    template <bool BandLimited>
+    void UnisonOscillator::renderScalar(float* left, float* right, int numSamples)
+    {
+        const float* gainLeft   = (nullptr != right) ? _gainLeft : _gainMono;
+        float endLevel          = _level;
+
+        for (int osc = 0; osc < _numOscillators; osc++)
+        {
+            float phase             = _phase[osc];
+            float lvl               = _level;
+            float inc               = _inc[osc];
+            float invInc            = _invInc[osc];
+            const float incStep     = _gliding ? ((_targetInc[osc] - inc) / static_cast<float>(numSamples)) : 0.0f;
+            const float invIncStep  = _gliding ? ((_targetInvInc[osc] - invInc) / static_cast<float>(numSamples)) : 0.0f;
+            const float gainL       = gainLeft[osc];
+            const float gainR       = _gainRight[osc];
+
+            for (int sample = 0; sample < numSamples; sample++)
+            {
+                lvl     = Ramped::next(lvl, _targetLevel);
+                inc    += incStep;
+                invInc += invIncStep;
+
+                const float saw = Saw::value<BandLimited>(phase, inc, invInc);
+
+                left[sample] += lvl * gainL * saw;
+                if (nullptr != right)
+                {
+                    right[sample] += lvl * gainR * saw;
+                }
+
+                phase = wrap(phase + inc);
+            }
+
+            _phase[osc] = phase;
+            endLevel    = lvl;
+        }
+
+        _level = endLevel;
+        endGlide();
+    }
+
+   #if BGM01_USE_SIMD
+    // @brief       SIMD kernel, one register of consecutive samples at a time. Each
+    //              oscillator is added into the same pair of registers, so nothing
+    //              has to be summed across lanes.
+    // @param       See render
+    template <bool BandLimited>
+    void UnisonOscillator::renderSimd(float* left, float* right, int numSamples)
+    {
+        constexpr int width = static_cast<int>(Vec::SIMDNumElements);
+
+        const float* gainLeft   = (nullptr != right) ? _gainLeft : _gainMono;
+        float lvl               = _level;
+
+        alignas(64) float mixLeft[width];
+        alignas(64) float mixRight[width];
+
+        // Lane n is n samples into the register. A glide adds a step to the increment
+        // before every sample, so lane n has moved on by n(n + 1) / 2 steps.
+        for (int lane = 0; lane < width; lane++)
+        {
+            mixLeft[lane]   = static_cast<float>(lane);
+            mixRight[lane]  = static_cast<float>(lane * (lane + 1)) / 2.0f;
+        }
+        const Vec offsets   = Vec::fromRawArray(mixLeft);
+        const Vec steps     = Vec::fromRawArray(mixRight);
+        const Vec nextStep  = offsets + Vec::expand(1.0f);
+
+        // Steps of the increments and of their reciprocals, which are close enough
+        // to linear over one render
+        float incStep[maxOscillators];
+        float invIncStep[maxOscillators];
+        for (int osc = 0; osc < _numOscillators; osc++)
+        {
+            incStep[osc]    = _gliding ? ((_targetInc[osc] - _inc[osc]) / static_cast<float>(numSamples)) : 0.0f;
+            invIncStep[osc] = _gliding ? ((_targetInvInc[osc] - _invInc[osc]) / static_cast<float>(numSamples)) : 0.0f;
+        }
+
+        for (int start = 0; start < numSamples; start += width)
+        {
+            const int count = juce::jmin(width, (numSamples - start));
+            Vec sumLeft     = Vec::expand(0.0f);
+            Vec sumRight    = Vec::expand(0.0f);
+
+            for (int osc = 0; osc < _numOscillators; osc++)
+            {
+                const Vec step  = Vec::expand(incStep[osc]);
+                const Vec inc   = Vec::expand(_inc[osc]) + (nextStep * step);
+                Vec phase       = Vec::expand(_phase[osc]) + (offsets * Vec::expand(_inc[osc])) + (steps * step);
+
+                // The increment is under half a cycle, so the last lane is at most
+                // width / 2 cycles ahead
+                for (int cycle = 0; cycle < (width / 2); cycle++)
+                {
+                    phase = wrap(phase);
+                }
+
+                const Vec invInc    = Vec::expand(_invInc[osc]) + (nextStep * Vec::expand(invIncStep[osc]));
+                const Vec saw       = Saw::value<BandLimited>(phase, inc, invInc);
+
+                sumLeft = sumLeft + (saw * Vec::expand(gainLeft[osc]));
+                if (nullptr != right)
+                {
+                    sumRight = sumRight + (saw * Vec::expand(_gainRight[osc]));
+                }
+
+                const float span    = static_cast<float>(count);
+                const float next    = _phase[osc] + (span * _inc[osc]) + (((span * (span + 1.0f)) / 2.0f) * incStep[osc]);
+                _phase[osc]         = next - std::floor(next);
+                _inc[osc]          += span * incStep[osc];
+                _invInc[osc]       += span * invIncStep[osc];
+            }
+
+            // The level ramp is the same for every oscillator, so it goes on the mix
+            sumLeft.copyToRawArray(mixLeft);
+            sumRight.copyToRawArray(mixRight);
+
+            for (int lane = 0; lane < count; lane++)
+            {
+                lvl = Ramped::next(lvl, _targetLevel);
+
+                left[start + lane] += lvl * mixLeft[lane];
+                if (nullptr != right)
+                {
+                    right[start + lane] += lvl * mixRight[lane];
+                }
+            }
+        }
+
+        _level = lvl;
+        endGlide();
+    }
+   #endif
+
+    // @brief       Function to recalculate the phase increments
+    // @param       glide = True to ramp to the new increments over the next render,
+    //                      false to jump straight to them
+    void UnisonOscillator::updateIncrements(bool glide)
+    {
+        for (int osc = 0; osc < maxOscillators; osc++)
+        {
+            _targetInc[osc]     = juce::jmin(20000.0f, (_freq * _ratio[osc])) * _sampleTime;
+            _targetInvInc[osc]  = 1.0f / _targetInc[osc];
+        }
+
+        _gliding = glide;
+        if (! glide)
+        {
+            endGlide();
+        }
+    }
+
+    // @brief       Function to finish a glide on its target increments exactly
+    // @param       None
+    void UnisonOscillator::endGlide()
+    {
+        std::copy(std::begin(_targetInc), std::end(_targetInc), std::begin(_inc));
+        std::copy(std::begin(_targetInvInc), std::end(_targetInvInc), std::begin(_invInc));
+        _gliding = false;
+    }
+}
+//==============================================================================
\ No newline at end of file
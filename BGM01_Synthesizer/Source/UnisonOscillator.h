@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    UnisonOscillator.h
+    Created: 21 Dec 2024 10:26:14am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscillatorKernels.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Stack of detuned saw oscillators for one voice, i.e. a supersaw. The
+    // oscillators are stored as a structure of arrays, and with SIMD each one
+    // is rendered 4 or 8 samples at a time and added into a shared mix. The
+    // detune is spread evenly either side of the note, as is the stereo pan,
+    // and the mix is scaled by 1/sqrt(n) to keep the loudness about the same.
+    class UnisonOscillator
+    {
+    public:
+        static constexpr int    maxOscillators  = 16;
+
+        // Detune ratios and pan gains for one stack setting. Made with makeStack,
+        // which can run off the audio thread, and copied in by setStack.
+        struct Stack
+        {
+            int     numOscillators              = 1;
+            float   spread                      = 0.0f;
+            float   ratio[maxOscillators]       = {};
+            float   gainLeft[maxOscillators]    = {};
+            float   gainRight[maxOscillators]   = {};
+            float   gainMono[maxOscillators]    = {};
+        };
+
+        UnisonOscillator();
+        ~UnisonOscillator()
+        {
+
+        }
+
+        void    setSampleRate(double sampleRate);
+        void    setBandLimited(bool bandLimited);
+        void    setFrequency(float freq);
+        void    glideFrequency(float freq);
+        void    setUnison(int numOscillators, float detuneCents, float spread);
+        void    setStack(const Stack& stack);
+        void    setLevel(float lvl);
+        void    resetPhases(juce::uint32 seed);
+
+        void    render(float* left, float* right, int numSamples);
+
+        int     getNumOscillators(void) const       { return _numOscillators; }
+
+        static Stack    makeStack(int numOscillators, float detuneCents, float spread);
+
+    private:
+        template <bool BandLimited>
+        void    renderScalar(float* left, float* right, int numSamples);
+       #if BGM01_USE_SIMD
+        template <bool BandLimited>
+        void    renderSimd(float* left, float* right, int numSamples);
+       #endif
+        void    updateIncrements(bool glide);
+        void    endGlide(void);
+
+        // Per oscillator state, the unused ones have zero gain
+        alignas(64) float   _phase[maxOscillators];
+        alignas(64) float   _inc[maxOscillators];
+        alignas(64) float   _invInc[maxOscillators];
+        alignas(64) float   _targetInc[maxOscillators];     // What a glide is ramping to
+        alignas(64) float   _targetInvInc[maxOscillators];
+        alignas(64) float   _gainLeft[maxOscillators];
+        alignas(64) float   _gainRight[maxOscillators];
+        alignas(64) float   _gainMono[maxOscillators];
+        float               _ratio[maxOscillators];     // Detune as a frequency ratio
+
+        float               _freq;
+        float               _sampleTime;
+        float               _level;
+        float               _targetLevel;
+        int                 _numOscillators;
+        bool                _bandLimited;
+        bool                _gliding;
+
+        JUCE_DECLARE_NON_COPYABLE(UnisonOscillator)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    WavetableBank.cpp
+    Created: 28 Dec 2024 11:05:37am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "WavetableBank.h"
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // @brief       Fourier series of the built in shapes, as sine amplitudes
+    // @param       table = Which shape
+    //              harmonic = Harmonic number from 1
+    static float basicHarmonic(int table, int harmonic)
+    {
+        const float h   = static_cast<float>(harmonic);
+        const bool odd  = (0 != (harmonic & 1));
+
+        switch (table)
+        {
+            case WavetableBank::sine:
+                return (1 == harmonic) ? 1.0f : 0.0f;
+
+            case WavetableBank::triangle:
+                // Peaks a quarter of a cycle in, like the sine
+                return odd ? ((0 == ((harmonic >> 1) & 1)) ? 1.0f : -1.0f) / (h * h) : 0.0f;
+
+            case WavetableBank::saw:
+                // Rises from -1 to 1 over the cycle, the same as SawtoothSynth
+                return -1.0f / h;
+
+            case WavetableBank::square:
+                // High for the first half of the cycle, the same as SquareSynth
+                return odd ? (1.0f / h) : 0.0f;
+
+            default:
+                return 0.0f;
+        }
+    }
+
+    // @brief       Constructor, the bank starts empty
+    WavetableBank::WavetableBank()
+    {
+        _data       = nullptr;
+        _tableSize  = 0;
+        _numTables  = 0;
+        _numLevels  = 0;
+    }
+
+    // @brief       Function to build the sine, triangle, saw and square tables in memory
+    // @param       tableSize = Samples per cycle, rounded up to a power of two
+    // @note        Allocates and runs an FFT per level, so keep it off the audio thread
+    void WavetableBank::createBasic(int tableSize)
+    {
+        tableSize = juce::nextPowerOfTwo(juce::jlimit(minTableSize, maxTableSize, tableSize));
+
+        const int order     = juce::findHighestSetBit(static_cast<juce::uint32>(tableSize));
+        const int numLevels = getNumLevelsForSize(tableSize);
+        const int stride    = tableSize + 1;
+
+        juce::HeapBlock<float> data(static_cast<size_t>(numBasicTables) * numLevels * stride);
+        juce::dsp::FFT fft(order);
+        std::vector<float> spectrum(static_cast<size_t>(2 * tableSize));
+
+        for (int table = 0; table < numBasicTables; table++)
+        {
+            float* first = data.get() + (static_cast<size_t>(table) * numLevels * stride);
+
+            for (int level = 0; level < numLevels; level++)
+            {
+                // Bin h holds harmonic h, a sine is a negative imaginary part
+                const int numHarmonics = juce::jmin(((tableSize / 2) >> level), ((tableSize / 2) - 1));
+                std::fill(spectrum.begin(), spectrum.end(), 0.0f);
+
+                for (int harmonic = 1; harmonic <= numHarmonics; harmonic++)
+                {
+                    spectrum[static_cast<size_t>(2 * harmonic) + 1] = -basicHarmonic(table, harmonic);
+                }
+
+                fft.performRealOnlyInverseTransform(spectrum.data());
+
+                float* samples = first + (static_cast<size_t>(level) * stride);
+                std::copy(spectrum.begin(), (spectrum.begin() + tableSize), samples);
+                samples[tableSize] = samples[0];
+            }
+
+            // One gain for the whole chain, so the level doesn't jump between mip levels
+            const auto range    = juce::FloatVectorOperations::findMinAndMax(first, stride);
+            const float peak    = juce::jmax(-range.getStart(), range.getEnd());
+            if (0.0f < peak)
+            {
+                juce::FloatVectorOperations::multiply(first, (1.0f / peak), (numLevels * stride));
+            }
+        }
+
+        clear();
+        _ownedData  = std::move(data);
+        _data       = _ownedData.get();
+        _tableSize  = tableSize;
+        _numTables  = numBasicTables;
+        _numLevels  = numLevels;
+    }
+
+    // @brief       Function to memory map a bank file
+    // @param       file = The .bgwt file
+    // @return      Why the file couldn't be used, the bank is left unchanged if it fails
+    juce::Result WavetableBank::loadFromFile(const juce::File& file)
+    {
+       #if JUCE_BIG_ENDIAN
+        return juce::Result::fail("Wavetable files are little endian and can't be mapped on this machine");
+       #else
+        auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (nullptr == mapped->getData())
+        {
+            return juce::Result::fail("Could not map " + file.getFullPathName());
+        }
+
+        const auto fileSize = mapped->getSize();
+        if (static_cast<size_t>(dataOffset) > fileSize)
+        {
+            return juce::Result::fail(file.getFullPathName() + " is too short to be a wavetable file");
+        }
+
+        Header header;
+        std::memcpy(&header, mapped->getData(), sizeof(header));
+
+        if ((fileMagic != header.magic) || (fileVersion != header.version))
+        {
+            return juce::Result::fail(file.getFullPathName() + " is not a wavetable file or is from a newer version");
+        }
+
+        const int tableSize = static_cast<int>(header.tableSize);
+        if ((! juce::isPowerOfTwo(tableSize)) || (minTableSize > tableSize) || (maxTableSize < tableSize)
+            || (0 == header.numTables) || (static_cast<juce::uint32>(maxTables) < header.numTables)
+            || (static_cast<juce::uint32>(getNumLevelsForSize(tableSize)) != header.numLevels))
+        {
+            return juce::Result::fail(file.getFullPathName() + " has an unsupported table layout");
+        }
+
+        const size_t numSamples = static_cast<size_t>(header.numTables) * header.numLevels * (header.tableSize + 1);
+        if ((dataOffset + (numSamples * sizeof(float))) > fileSize)
+        {
+            return juce::Result::fail(file.getFullPathName() + " is truncated");
+        }
+
+        // Mappings start on a page boundary, so the samples are aligned
+        clear();
+        _mappedFile = std::move(mapped);
+        _data       = reinterpret_cast<const float*>(static_cast<const char*>(_mappedFile->getData()) + dataOffset);
+        _tableSize  = tableSize;
+        _numTables  = static_cast<int>(header.numTables);
+        _numLevels  = static_cast<int>(header.numLevels);
+        return juce::Result::ok();
+       #endif
+    }
+
+    // @brief       Function to write the bank out in the file format
+    // @param       file = The .bgwt file, replaced if it exists
+    // @return      Why the file couldn't be written
+    // @note        Written to a temporary file and moved into place, so anything
+    //              that has the old file mapped keeps its copy
+    juce::Result WavetableBank::saveToFile(const juce::File& file) const
+    {
+        if (! isLoaded())
+        {
+            return juce::Result::fail("There are no tables to save");
+        }
+
+        juce::TemporaryFile temp(file);
+
+        {
+            juce::FileOutputStream stream(temp.getFile());
+            if (! stream.openedOk())
+            {
+                return juce::Result::fail("Could not create " + temp.getFile().getFullPathName());
+            }
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            header.magic        = fileMagic;
+            header.version      = fileVersion;
+            header.tableSize    = static_cast<juce::uint32>(_tableSize);
+            header.numTables    = static_cast<juce::uint32>(_numTables);
+            header.numLevels    = static_cast<juce::uint32>(_numLevels);
+
+            const char padding[dataOffset - sizeof(Header)] = {};
+
+            if ((! stream.write(&header, sizeof(header)))
+                || (! stream.write(padding, sizeof(padding)))
+                || (! stream.write(_data, (getNumSamples() * sizeof(float)))))
+            {
+                return juce::Result::fail("Could not write " + temp.getFile().getFullPathName());
+            }
+
+            stream.flush();
+            if (stream.getStatus().failed())
+            {
+                return stream.getStatus();
+            }
+        }
+
+        if (! temp.overwriteTargetFileWithTemporary())
+        {
+            return juce::Result::fail("Could not replace " + file.getFullPathName());
+        }
+
+        return juce::Result::ok();
+    }
+
+    // @brief       Function to empty the bank, releasing the memory or the mapping
+    // @param       None
+    void WavetableBank::clear()
+    {
+        _mappedFile.reset();
+        _ownedData.free();
+        _data       = nullptr;
+        _tableSize  = 0;
+        _numTables  = 0;
+        _numLevels  = 0;
+    }
+
+    // @brief       Function to pick the mip level for a pitch
+    // @param       phaseIncrement = Cycles per sample of the note
+    // @return      The most detailed level with nothing above Nyquist
+    int WavetableBank::getLevelForIncrement(float phaseIncrement) const
+    {
+        // Level n is safe while (tableSize / 2) >> n harmonics stay under half a cycle per sample
+        const float span = phaseIncrement * static_cast<float>(_tableSize);
+        if (1.0f >= span)
+        {
+            return 0;
+        }
+
+        const int level = static_cast<int>(std::ceil(std::log2(span)));
+        return juce::jlimit(0, (_numLevels - 1), level);
+    }
+
+    // @brief       Function to get the samples of one mip level
+    // @param       table = Table index
+    //              level = Mip level, 0 is the most detailed
+    // @return      tableSize + 1 samples, the last one repeats the first
+    const float* WavetableBank::getTable(int table, int level) const
+    {
+        jassert(juce::isPositiveAndBelow(table, _numTables));
+        jassert(juce::isPositiveAndBelow(level, _numLevels));
+
+        return _data + ((static_cast<size_t>(table) * _numLevels) + level) * (_tableSize + 1);
+    }
+
+    // @brief       Function to get the number of mip levels for a table size
+    // @param       tableSize = Samples per cycle, a power of two
+    // @return      Levels from tableSize / 2 harmonics down to 1
+    int WavetableBank::getNumLevelsForSize(int tableSize)
+    {
+        return juce::findHighestSetBit(static_cast<juce::uint32>(tableSize));
+    }
+
+    // @brief       Function to get the number of samples in the whole bank
+    // @param       None
+    size_t WavetableBank::getNumSamples() const
+    {
+        return static_cast<size_t>(_numTables) * _numLevels * (_tableSize + 1);
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    WavetableBank.h
+    Created: 28 Dec 2024 11:05:37am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Set of single cycle wavetables, each stored as a chain of band limited mip
+    // levels. Level n keeps the harmonics up to (tableSize / 2) >> n, so a note
+    // reads the level that has nothing above Nyquist at its pitch.
+    //
+    // Banks are either built in memory or loaded from a .bgwt file, which is
+    // memory mapped rather than read. The file is laid out exactly like the
+    // tables in memory, so loading is only a header check however large the
+    // bank is, the pages are read as they're played, and every instance (or
+    // process) mapping the same file shares one copy of it.
+    //
+    // File layout, little endian:
+    //      Header          32 bytes, see below
+    //      Padding         up to dataOffset, so the samples are cache line aligned
+    //      Samples         float[numTables][numLevels][tableSize + 1]
+    // Each level ends with a copy of its first sample, so interpolation never wraps.
+    class WavetableBank
+    {
+    public:
+        static constexpr juce::uint32   fileMagic           = 0x54574742;   // "BGWT"
+        static constexpr juce::uint32   fileVersion         = 1;
+        static constexpr int            dataOffset          = 64;
+        static constexpr int            minTableSize        = 64;
+        static constexpr int            maxTableSize        = 65536;
+        static constexpr int            defaultTableSize    = 2048;
+        static constexpr int            maxTables           = 1024;
+
+        // Shapes of the built in bank, in table order
+        enum BasicTable
+        {
+            sine = 0,
+            triangle,
+            saw,
+            square,
+            numBasicTables
+        };
+
+        struct Header
+        {
+            juce::uint32    magic;
+            juce::uint32    version;
+            juce::uint32    tableSize;
+            juce::uint32    numTables;
+            juce::uint32    numLevels;
+            juce::uint32    reserved[3];
+        };
+
+        WavetableBank();
+        ~WavetableBank()
+        {
+
+        }
+
+        void            createBasic(int tableSize);
+        juce::Result    loadFromFile(const juce::File& file);
+        juce::Result    saveToFile(const juce::File& file) const;
+        void            clear(void);
+
+        bool            isLoaded(void) const                { return nullptr != _data; }
+        bool            isMapped(void) const                { return nullptr != _mappedFile; }
+        int             getNumTables(void) const            { return _numTables; }
+        int             getNumLevels(void) const            { return _numLevels; }
+        int             getTableSize(void) const            { return _tableSize; }
+
+        int             getLevelForIncrement(float phaseIncrement) const;
+        const float*    getTable(int table, int level) const;
+
+        static int      getNumLevelsForSize(int tableSize);
+
+    private:
+        size_t          getNumSamples(void) const;
+
+        std::unique_ptr<juce::MemoryMappedFile>     _mappedFile;
+        juce::HeapBlock<float>                      _ownedData;
+        const float*                                _data;
+        int                                         _tableSize;
+        int                                         _numTables;
+        int                                         _numLevels;
+
+        JUCE_DECLARE_NON_COPYABLE(WavetableBank)
+    };
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+    Created: 14 Dec 2024 11:02:48am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include "AllocationGuard.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // How long an idle worker keeps checking for a batch before it parks, in
+    // block periods. More than one, so a callback that runs late doesn't find
+    // the workers parked.
+    static constexpr double spinBlocks  = 2.0;
+
+    // Spins between looking at the clock
+    static constexpr int spinIterations = 64;
+
+    // Parked workers check again after this long, in case a wake up was missed
+    static constexpr int parkTimeoutMs  = 100;
+
+    // @brief       Function to tell the CPU we are in a spin loop
+    // @param       None
+    static inline void spinPause()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+
+    // @brief       Constructor, the pool starts without workers
+    WorkerPool::WorkerPool()
+    {
+        _numWorkers = 0;
+        _spinTicks  = 0;
+        _job        = nullptr;
+        _jobsDone   = 0;
+        _state      = 0;
+    }
+
+    // @brief       Destructor, stops the workers
+    WorkerPool::~WorkerPool()
+    {
+        stop();
+    }
+
+    // @brief       Function to start the worker threads, replacing any running ones
+    // @param       numWorkers = Number of threads besides the caller's, 0 runs every job on the caller
+    //              blockSize = Samples per block, used to work out the real-time period
+    //              sampleRate = Sample rate of the blocks
+    void WorkerPool::start(int numWorkers, int blockSize, double sampleRate)
+    {
+        stop();
+
+        const double blockSeconds = (0.0 < sampleRate) ? (juce::jmax(1, blockSize) / sampleRate) : 0.01;
+        _spinTicks  = static_cast<juce::int64>(spinBlocks * blockSeconds * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()));
+
+        _numWorkers = juce::jlimit(0, maxWorkers, numWorkers);
+        for (int index = 0; index < _numWorkers; index++)
+        {
+            _workers[index] = std::make_unique<Worker>(*this, index);
+
+            const auto options = juce::Thread::RealtimeOptions().withApproximateAudioProcessingTime(blockSize, sampleRate);
+            if (! _workers[index]->startRealtimeThread(options))
+            {
+                _workers[index]->startThread(juce::Thread::Priority::highest);
+            }
+        }
+    }
+
+    // @brief       Function to stop and delete the worker threads
+    // @param       None
+    void WorkerPool::stop()
+    {
+        for (int index = 0; index < _numWorkers; index++)
+        {
+            _workers[index]->signalThreadShouldExit();
+            _workers[index]->wakeUp.signal();
+        }
+
+        for (int index = 0; index < _numWorkers; index++)
+        {
+            _workers[index]->stopThread(1000);
+            _workers[index].reset();
+        }
+
+        _numWorkers = 0;
+    }
+
+    // @brief       Function to run a batch of jobs, returns once all of them are done
+    // @param       job = The work, runJob is called once with each index
+    //              numJobs = Number of jobs in the batch
+    // @note        Real-time safe, the caller runs jobs too
+    void WorkerPool::run(Job& job, int numJobs)
+    {
+        jassert(numJobs <= 0xffff);
+
+        if ((0 == _numWorkers) || (1 >= numJobs))
+        {
+            for (int index = 0; index < numJobs; index++)
+            {
+                job.runJob(index);
+            }
+            return;
+        }
+
+        _job.store(&job, std::memory_order_relaxed);
+        _jobsDone.store(0, std::memory_order_relaxed);
+
+        const juce::uint32 generation = getGeneration(_state.load(std::memory_order_relaxed)) + 1;
+        _state.store(makeState(generation, numJobs), std::memory_order_seq_cst);
+
+        wakeWorkers();
+        runJobs(generation);
+
+        // Our share is done, the last few jobs finish on the workers
+        while (numJobs > _jobsDone.load(std::memory_order_acquire))
+        {
+            spinPause();
+        }
+    }
+
+    // @brief       Function to claim and run jobs until the batch runs out
+    // @param       generation = The batch to work on
+    void WorkerPool::runJobs(juce::uint32 generation)
+    {
+        auto state = _state.load(std::memory_order_acquire);
+
+        while ((getGeneration(state) == generation) && (getNextJob(state) < getNumJobs(state)))
+        {
+            if (_state.compare_exchange_weak(state, (state + 1), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                _job.load(std::memory_order_relaxed)->runJob(getNextJob(state));
+                _jobsDone.fetch_add(1, std::memory_order_release);
+
+                state = _state.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    // @brief       Function to wake the workers that have parked
+    // @param       None
+    void WorkerPool::wakeWorkers()
+    {
+        // Only parked workers need the event, spinning ones see the new batch themselves.
+        // Signalling is a system call, but workers only park after a pause in the audio.
+        for (int index = 0; index < _numWorkers; index++)
+        {
+            auto& worker = *_workers[index];
+            if (worker.parked.exchange(false, std::memory_order_seq_cst))
+            {
+                worker.wakeUp.signal();
+            }
+        }
+    }
+
+    //==============================================================================
+    // @brief       Constructor
+    // @param       pool = The pool the worker belongs to
+    //              index = Worker number, used for the thread name
+    WorkerPool::Worker::Worker(WorkerPool& pool, int index) :   juce::Thread("BGM01 worker " + juce::String(index)),
+                                                                _pool(pool)
+    {
+
+    }
+
+    // @brief       Thread function, waits for batches and helps run them
+    // @param       None
+    void WorkerPool::Worker::run()
+    {
+        // Flush to zero is per thread, the jobs must run the same here as on the audio thread
+        juce::ScopedNoDenormals noDenormals;
+
+        juce::uint32 seen = getGeneration(_pool._state.load(std::memory_order_acquire));
+
+        while (! threadShouldExit())
+        {
+            // Keep checking until the next block is overdue, then park
+            auto state = _pool._state.load(std::memory_order_acquire);
+            const auto spinEnd = juce::Time::getHighResolutionTicks() + _pool._spinTicks;
+            while ((getGeneration(state) == seen) && (juce::Time::getHighResolutionTicks() < spinEnd))
+            {
+                for (int spin = 0; (spin < spinIterations) && (getGeneration(state) == seen); spin++)
+                {
+                    spinPause();
+                    state = _pool._state.load(std::memory_order_acquire);
+                }
+            }
+
+            if (getGeneration(state) == seen)
+            {
+                // Check again after flagging, a batch published in between sees the flag
+                parked.store(true, std::memory_order_seq_cst);
+                if (getGeneration(_pool._state.load(std::memory_order_seq_cst)) == seen)
+                {
+                    wakeUp.wait(parkTimeoutMs);
+                }
+                parked.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            // The jobs are part of the audio callback, hold them to the same rules
+            seen = getGeneration(state);
+            ScopedAllocationTrap allocationTrap;
+            _pool.runJobs(seen);
+        }
+    }
+}
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    Created: 14 Dec 2024 11:02:48am
+    Author:  brand
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// BGM01 Namespace for synthesizer
+namespace BGM01
+{
+    // Fixed pool of worker threads that help the audio thread through a batch
+    // of jobs. The threads are started up front with real-time priority, so
+    // running a batch never creates threads, allocates or takes a lock. The
+    // caller publishes the batch with one atomic store and works through the
+    // jobs too, claiming them from a shared counter, then spins until the
+    // workers have finished theirs.
+    //
+    // Idle workers spin for two block periods before they park on an event, so
+    // while audio is running they are always spinning when the next block comes
+    // and the caller never makes a system call. Only the first block after a
+    // pause (the device stopped, or the engine went silent) finds them parked
+    // and signals the event, which costs a futex wake and the OS wake up time.
+    class WorkerPool
+    {
+    public:
+        // Work handed to the pool, run once for each job index of a batch
+        class Job
+        {
+        public:
+            virtual ~Job() = default;
+            virtual void    runJob(int index) = 0;
+        };
+
+        static constexpr int    maxWorkers  = 16;
+
+        WorkerPool();
+        ~WorkerPool();
+
+        void    start(int numWorkers, int blockSize, double sampleRate);
+        void    stop(void);
+        void    run(Job& job, int numJobs);
+
+        int     getNumWorkers(void) const       { return _numWorkers; }
+
+    private:
+        class Worker : public juce::Thread
+        {
+        public:
+            Worker(WorkerPool& pool, int index);
+            ~Worker() override
+            {
+
+            }
+
+            void    run(void) override;
+
+            // Set while waiting on the event, so the caller knows to signal it
+            std::atomic<bool>       parked      { false };
+            juce::WaitableEvent     wakeUp;
+
+        private:
+            WorkerPool&     _pool;
+
+            JUCE_DECLARE_NON_COPYABLE(Worker)
+        };
+
+        void    runJobs(juce::uint32 generation);
+        void    wakeWorkers(void);
+
+        static juce::uint64 makeState(juce::uint32 generation, int numJobs)
+        {
+            return (static_cast<juce::uint64>(generation) << 32) | (static_cast<juce::uint64>(numJobs) << 16);
+        }
+        static juce::uint32 getGeneration(juce::uint64 state)   { return static_cast<juce::uint32>(state >> 32); }
+        static int          getNumJobs(juce::uint64 state)      { return static_cast<int>((state >> 16) & 0xffff); }
+        static int          getNextJob(juce::uint64 state)      { return static_cast<int>(state & 0xffff); }
+
+        std::array<std::unique_ptr<Worker>, maxWorkers> _workers;
+        int                         _numWorkers;
+        juce::int64                 _spinTicks;     // How long an idle worker spins before parking
+
+        // The batch being run, published by the store to _state
+        std::atomic<Job*>           _job;
+        std::atomic<int>            _jobsDone;
+
+        // Batch generation in the top 32 bits, then the number of jobs and the next
+        // job to claim in 16 bits each. Keeping them in one word means a late worker
+        // can never claim a job of one batch using the counts of another.
+        std::atomic<juce::uint64>   _state;
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+    };
+}
+//==============================================================================
\ No newline at end of file